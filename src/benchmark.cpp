@@ -0,0 +1,234 @@
+/// @file
+///
+/// @brief This file contains the implementation of the benchmarks.
+///
+/// The toggle measurements are executed from flash. Flash wait states affect all
+/// measured variants equally. The bit-bang measurements are executed from ram, like
+/// the bit-bang engines in the application.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+
+#include <stdio.h>
+#include <stdint.h>
+#include "benchmark.h"
+#include "bitbang.h"
+#include "cycle_counter.h"
+#include "gpio.h"
+#include "isr.h"
+#include "kernel.h"
+#include "mcu.h"
+#include "utils.h"
+
+/// @brief Measures BENCHMARK_ITERATIONS toggles through the type erased IGpioPin interface.
+///
+/// @param pin The pin to toggle. Each toggle is dispatched through the vtable.
+/// @returns The number of cycles which were needed.
+static uint32_t measureVirtualToggle(IGpioPin* pin)
+{
+    uint32_t start = CycleCounter::now();
+    for (unsigned i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        pin->toggleOut();
+    }
+    return CycleCounter::now() - start;
+}
+
+/// @brief Measures BENCHMARK_ITERATIONS toggles through the static GpioPin access object.
+///
+/// @tparam Pin The static access object of the pin to toggle.
+/// @returns The number of cycles which were needed.
+template<class Pin>
+    static uint32_t measureStaticToggle()
+    {
+        uint32_t start = CycleCounter::now();
+        for (unsigned i = 0; i < BENCHMARK_ITERATIONS; i++)
+        {
+            Pin::toggleOut();
+        }
+        return CycleCounter::now() - start;
+    }
+
+/// @brief Compares virtual and static toggles of a single pin and prints the result.
+///
+/// @tparam pinId The pin identifier.
+/// @param name The name of the pin which is printed.
+template<GpioPinId pinId>
+    static void benchmarkToggle(const char_t* name)
+    {
+        GpioController gpioCtrl;
+        // Storing the pointer in a volatile variable prevents that gcc devirtualizes the calls.
+        IGpioPin* volatile pin = gpioCtrl.getPin<pinId>();
+
+        uint32_t virtualCycles = measureVirtualToggle(pin);
+        uint32_t staticCycles = measureStaticToggle<GpioPin<pinId> >();
+
+        printf("%s toggle: virtual %lu cycles, static %lu cycles (%u toggles)\n", name,
+                (unsigned long) virtualCycles, (unsigned long) staticCycles, BENCHMARK_ITERATIONS);
+    }
+
+/// SPI engine at maximum bit rate on the debug pins 2 (SCK), 3 (MOSI) and 4 (MISO).
+typedef BitBangSpi<GpioPin<DEBUG_PIN2>, GpioPin<DEBUG_PIN3>, GpioPin<DEBUG_PIN4> > BenchmarkSpi;
+
+/// I2C engine at maximum bit rate on the debug pins 2 (SCL) and 3 (SDA). No slave is connected.
+typedef BitBangI2c<GpioPin<DEBUG_PIN2>, GpioPin<DEBUG_PIN3>, 0> BenchmarkI2c;
+
+/// @brief Measures BENCHMARK_ITERATIONS byte transfers of the SPI engine.
+///
+/// @attention gcc ignores section attributes of function templates. Therefore this function
+/// is not a template.
+///
+/// @returns The number of cycles which were needed.
+static RAMFUNC uint32_t measureSpiTransfer()
+{
+    uint32_t start = CycleCounter::now();
+    for (unsigned i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        BenchmarkSpi::transfer((uint8_t) i);
+    }
+    return CycleCounter::now() - start;
+}
+
+/// @brief Measures BENCHMARK_ITERATIONS byte writes (including the acknowledge bit) of the I2C engine.
+///
+/// @returns The number of cycles which were needed.
+static RAMFUNC uint32_t measureI2cWrite()
+{
+    uint32_t start = CycleCounter::now();
+    for (unsigned i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        BenchmarkI2c::write((uint8_t) i);
+    }
+    return CycleCounter::now() - start;
+}
+
+/// @brief Prints the bit rate of a bit-bang measurement.
+///
+/// @param name The name of the engine which is printed.
+/// @param bits Number of bits which were transferred.
+/// @param cycles The number of cycles which were needed.
+static void printBitRate(const char_t* name, const uint32_t bits, const uint32_t cycles)
+{
+    const uint32_t kbitPerSecond = (uint32_t) (((uint64_t) bits * SystemCoreClock) / cycles / 1000u);
+    printf("%s: %lu cycles per bit, %lu kbit/s\n", name, (unsigned long) (cycles / bits),
+            (unsigned long) kbitPerSecond);
+}
+
+/// The irq which is raised by software for the latency measurements. Base timer 7 is not used.
+static const IRQn_Type BENCHMARK_IRQ = BT7_IRQn;
+
+static volatile uint32_t entryTimestamp; ///< Value of the cycle counter at the first instruction of the handler.
+
+/// This class records the entry time of the benchmark irq.
+struct LatencyHandler : public IInterruptServiceRoutine
+{
+    /// Implements IInterruptServiceRoutine::isr()
+    ReturnCode isr()
+    {
+        return handleIrq();
+    }
+
+    /// Records the entry time. It is bound directly to the vector by IsrBinding.
+    STATIC_INLINE ReturnCode handleIrq()
+    {
+        entryTimestamp = CycleCounter::now();
+        return RC_OK;
+    }
+};
+
+static LatencyHandler latencyHandler; ///< The handler object which is registered for the indirect path.
+
+extern "C" void ISR_Systick();
+
+/// @brief Measures the latency from pending the benchmark irq to the first instruction of the handler body.
+///
+/// The latency includes the exception entry of the core (stacking, vector fetch) and the dispatch
+/// of the installed routine. The irq is pended BENCHMARK_ITERATIONS times.
+///
+/// @param handler The interrupt service routine which is installed for the measurement.
+/// @returns The number of cycles which were needed in total.
+static uint32_t measureIrqLatency(IsrHandler handler)
+{
+    const IsrHandler previous = ISR_install(BENCHMARK_IRQ, handler);
+    NVIC_ClearPendingIRQ(BENCHMARK_IRQ);
+    NVIC_EnableIRQ(BENCHMARK_IRQ);
+
+    uint32_t cycles = 0;
+    for (unsigned i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        const uint32_t start = CycleCounter::now();
+        NVIC_SetPendingIRQ(BENCHMARK_IRQ);
+#ifdef HOST_SIMULATION
+        handler(); // the host does not take exceptions
+#endif
+        __DSB();
+        __ISB(); // the irq is taken at the latest here
+        cycles += entryTimestamp - start;
+    }
+
+    NVIC_DisableIRQ(BENCHMARK_IRQ);
+    ISR_install(BENCHMARK_IRQ, previous);
+    return cycles;
+}
+
+#ifndef HOST_SIMULATION
+static KernelSemaphore switchRequest(0u); ///< Signaled by the measuring thread, the switch thread waits for it.
+static volatile uint32_t switchStart; ///< Value of the cycle counter before the switch thread is signaled.
+static uint32_t switchCycles; ///< Sum of the measured context switches.
+static KernelThread switchThread; ///< The thread which is switched to.
+static uint64_t switchStack[64]; ///< The stack of the switch thread.
+
+/// The entry function of the switch thread. It records the end of each switch and waits again.
+static void switchEntry(void*)
+{
+    for (unsigned i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        KERNEL_wait(switchRequest);
+        switchCycles += CycleCounter::now() - switchStart;
+    }
+}
+
+/// @brief Measures the time from signaling a semaphore to the resume of the thread which waits for it.
+///
+/// The time includes KERNEL_signal(), the PendSV entry and the context switch. The switch thread has
+/// the highest priority, so it runs as soon as the critical section of KERNEL_signal() is left.
+///
+/// @returns The number of cycles which were needed in total.
+static uint32_t measureContextSwitch()
+{
+    switchCycles = 0;
+    KERNEL_createThread(switchThread, &switchEntry, NULL, switchStack, sizeof(switchStack), KERNEL_PRIORITIES - 1u);
+
+    for (unsigned i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        switchStart = CycleCounter::now();
+        KERNEL_signal(switchRequest);
+    }
+    return switchCycles;
+}
+#endif
+
+void BENCHMARK_run()
+{
+    benchmarkToggle<DEBUG_PIN1>("DEBUG_PIN1");
+    benchmarkToggle<DEBUG_PIN2>("DEBUG_PIN2");
+    benchmarkToggle<DEBUG_PIN3>("DEBUG_PIN3");
+    benchmarkToggle<DEBUG_PIN4>("DEBUG_PIN4");
+
+    printBitRate("bit-bang SPI", 8u * BENCHMARK_ITERATIONS, measureSpiTransfer());
+    printBitRate("bit-bang I2C", 9u * BENCHMARK_ITERATIONS, measureI2cWrite());
+
+    // The indirect path is the systick routine itself: trampoline, global pointer, vtable, isr(). It is
+    // installed at the benchmark irq, the systick keeps its own vector.
+    IInterruptServiceRoutine* const registered = ISR_registerSysTick(&latencyHandler);
+    const uint32_t indirectCycles = measureIrqLatency(&ISR_Systick);
+    ISR_registerSysTick(registered);
+    const uint32_t boundCycles = measureIrqLatency(&IsrBinding<&LatencyHandler::handleIrq>::entry);
+    printf("irq entry latency: registered isr() %lu cycles, IsrBinding %lu cycles (average of %u irqs)\n",
+            (unsigned long) (indirectCycles / BENCHMARK_ITERATIONS),
+            (unsigned long) (boundCycles / BENCHMARK_ITERATIONS), BENCHMARK_ITERATIONS);
+
+#ifndef HOST_SIMULATION
+    printf("context switch: %lu cycles from KERNEL_signal() to the waiting thread (average of %u switches)\n",
+            (unsigned long) (measureContextSwitch() / BENCHMARK_ITERATIONS), BENCHMARK_ITERATIONS);
+#endif
+}
@@ -0,0 +1,25 @@
+/// @file
+///
+/// @brief This file contains the benchmarks which measure the execution time of the system.
+///
+/// All measurements are done with the dwt cycle counter. The results are printed with printf.
+/// The benchmarks are only run when the macro ENABLE_BENCHMARKS is defined (see Makefile).
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+/// Number of repetitions of each measured operation.
+#define BENCHMARK_ITERATIONS 1000
+
+/// @brief This function runs all benchmarks and prints their results.
+///
+/// @attention All debug pins are used by the benchmarks. They are toggled
+/// and must be initialized as outputs before calling this function.
+///
+/// @attention The context switch is measured with kernel threads. The function must be called
+/// by a thread of the running kernel (see kernel.h).
+void BENCHMARK_run();
+
+#endif
@@ -0,0 +1,299 @@
+/// @file
+///
+/// @brief This file contains the bit-bang protocol engines.
+///
+/// Peripherals which are wired to pins without a multi function serial (MFS) channel are
+/// driven by software. The engines are class templates over static pin access objects
+/// (GpioPin, GpioNoPin). Each pin access resolves to a single bit-band load or store, the
+/// bit loop is unrolled at compile time and the clock phases are padded with NopUnroller.
+/// No branch depends on the transferred data, so every bit takes the same number of cycles.
+///
+/// The timing is only deterministic when the code runs from ram and is not interrupted.
+/// gcc ignores section attributes of function templates. The engines are therefore called
+/// from non-template RAMFUNC wrappers, one for each bus of the application:
+///
+/// @code
+/// typedef BitBangSpi<GpioPin<DEBUG_PIN2>, GpioPin<DEBUG_PIN3>, GpioPin<DEBUG_PIN4>, 4> DisplaySpi;
+///
+/// RAMFUNC uint8_t displayTransfer(const uint8_t value)
+/// {
+///     return DisplaySpi::transfer(value);
+/// }
+/// @endcode
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup BitBang
+
+#ifndef __BITBANG_H__
+#define __BITBANG_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "cycle_counter.h"
+#include "gpio.h"
+#include "utils.h"
+
+/// @brief This module contains software implementations of serial protocols.
+///
+/// @defgroup BitBang Bit-Bang Protocols
+
+/// @brief This template class unrolls the shifting of a word at compile time.
+///
+/// The word is shifted out and in with the most significant bit first. Each bit is
+/// transferred by the method Bus::shiftBit().
+///
+/// @tparam Bus The protocol engine. It must provide STATIC_INLINE uint32_t shiftBit(uint32_t).
+/// @tparam count Number of bits which are shifted.
+/// @ingroup BitBang
+template<class Bus, unsigned count>
+    struct BitBangUnroller
+    {
+        /// @brief This method shifts the remaining bits.
+        ///
+        /// @param out The word to send. Bit count - 1 is sent next.
+        /// @param in The bits which were received so far.
+        /// @returns The received word.
+        STATIC_INLINE uint32_t shift(const uint32_t out, const uint32_t in)
+        {
+            return BitBangUnroller<Bus, count - 1>::shift(out,
+                    (in << 1) | Bus::shiftBit((out >> (count - 1)) & 1u));
+        }
+    };
+/// @cond TEMPLATE_DOC
+
+template<class Bus>
+    struct BitBangUnroller<Bus, 0>
+    {
+        STATIC_INLINE uint32_t shift(const uint32_t out, const uint32_t in)
+        {
+            return in;
+        }
+    };
+/// @endcond
+
+/// @brief This template class is a SPI master in mode 0 (CPOL = 0, CPHA = 0).
+///
+/// The data is sampled on the rising and shifted on the falling edge of the clock. The
+/// chip select is not handled, use a GpioPin of the application.
+///
+/// @tparam Sck The static access object of the clock pin. It must be initialized as output low.
+/// @tparam Mosi The static access object of the data output pin. GpioNoPin for receive only.
+/// @tparam Miso The static access object of the data input pin. GpioNoPin for transmit only.
+/// @tparam halfPeriodNops Number of nops which are inserted into each half clock period.
+///         0 gives the maximum bit rate.
+/// @ingroup BitBang
+template<class Sck, class Mosi, class Miso, unsigned halfPeriodNops = 0>
+    struct BitBangSpi
+    {
+        /// @brief This method sends and receives a byte.
+        ///
+        /// @param value The byte to send.
+        /// @returns The received byte.
+        STATIC_INLINE uint8_t transfer(const uint8_t value)
+        {
+            return (uint8_t) BitBangUnroller<BitBangSpi, 8>::shift(value, 0u);
+        }
+
+        /// @brief This method sends and receives a buffer.
+        ///
+        /// @param out The bytes to send.
+        /// @param in The received bytes are written to this buffer. It may be equal to out.
+        /// @param length Number of bytes to transfer.
+        STATIC_INLINE void transfer(const uint8_t* out, uint8_t* in, const uint32_t length)
+        {
+            for (uint32_t i = 0; i < length; i++)
+            {
+                in[i] = transfer(out[i]);
+            }
+        }
+
+        /// @brief This method transfers a single bit. It is used by BitBangUnroller.
+        ///
+        /// @param bit The bit to send (0 or 1).
+        /// @returns The received bit.
+        STATIC_INLINE uint32_t shiftBit(const uint32_t bit)
+        {
+            Mosi::setOut(bit);
+            UTILS_nopUnroll<halfPeriodNops>();
+            Sck::setOutHigh();
+            const uint32_t received = Miso::getIn();
+            UTILS_nopUnroll<halfPeriodNops>();
+            Sck::setOutLow();
+            return received;
+        }
+
+    private:
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        BitBangSpi();
+    };
+
+/// @brief This template class is an I2C master.
+///
+/// Both pins must be initialized with GPIO_OUTPUT_OPEN_DRAIN and have an external pull-up. A high
+/// output releases the line. Clock stretching of the slaves is not supported.
+///
+/// @tparam Scl The static access object of the clock pin.
+/// @tparam Sda The static access object of the data pin.
+/// @tparam halfPeriodNops Number of nops which are inserted into each half clock period.
+///         The bus speed of the slowest slave must not be exceeded.
+/// @ingroup BitBang
+template<class Scl, class Sda, unsigned halfPeriodNops>
+    struct BitBangI2c
+    {
+        /// @brief This method generates a start or repeated start condition.
+        STATIC_INLINE void start()
+        {
+            Sda::setOutHigh();
+            UTILS_nopUnroll<halfPeriodNops>();
+            Scl::setOutHigh();
+            UTILS_nopUnroll<halfPeriodNops>();
+            Sda::setOutLow();
+            UTILS_nopUnroll<halfPeriodNops>();
+            Scl::setOutLow();
+        }
+
+        /// @brief This method generates a stop condition.
+        STATIC_INLINE void stop()
+        {
+            Sda::setOutLow();
+            UTILS_nopUnroll<halfPeriodNops>();
+            Scl::setOutHigh();
+            UTILS_nopUnroll<halfPeriodNops>();
+            Sda::setOutHigh();
+            UTILS_nopUnroll<halfPeriodNops>();
+        }
+
+        /// @brief This method sends a byte and reads the acknowledge of the slave.
+        ///
+        /// @param value The byte to send.
+        /// @returns TRUE when the slave acknowledged the byte.
+        STATIC_INLINE boolean_t write(const uint8_t value)
+        {
+            BitBangUnroller<BitBangI2c, 8>::shift(value, 0u);
+            return shiftBit(1u) == 0u;
+        }
+
+        /// @brief This method reads a byte and sends the acknowledge.
+        ///
+        /// @param ack TRUE to acknowledge the byte, FALSE for the last byte of a read.
+        /// @returns The received byte.
+        STATIC_INLINE uint8_t read(const boolean_t ack)
+        {
+            const uint8_t value = (uint8_t) BitBangUnroller<BitBangI2c, 8>::shift(0xFFu, 0u);
+            shiftBit(ack ? 0u : 1u);
+            return value;
+        }
+
+        /// @brief This method transfers a single bit. It is used by BitBangUnroller.
+        ///
+        /// @param bit The bit to send (0 or 1). 1 releases the data line, so the slave can drive it.
+        /// @returns The level of the data line while the clock is high.
+        STATIC_INLINE uint32_t shiftBit(const uint32_t bit)
+        {
+            Sda::setOut(bit);
+            UTILS_nopUnroll<halfPeriodNops>();
+            Scl::setOutHigh();
+            UTILS_nopUnroll<halfPeriodNops>();
+            const uint32_t received = Sda::getIn();
+            Scl::setOutLow();
+            return received;
+        }
+
+    private:
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        BitBangI2c();
+    };
+
+/// @brief This template class is a 1-Wire master.
+///
+/// The 1-Wire time slots are in the range of microseconds. They are timed with the cycle counter
+/// instead of nops. The bits are sent with the least significant bit first.
+///
+/// @attention The time slots must not be interrupted. Call the methods with disabled irqs.
+///
+/// @tparam Pin The static access object of the data pin. It must be initialized with
+///         GPIO_OUTPUT_OPEN_DRAIN and have an external pull-up.
+/// @tparam cyclesPerUs Number of cpu cycles per microsecond.
+/// @ingroup BitBang
+template<class Pin, uint32_t cyclesPerUs = __HCLK / 1000000ul>
+    struct BitBangOneWire
+    {
+        /// @brief This method sends a reset pulse and waits for the presence pulse.
+        ///
+        /// @returns TRUE when at least one slave answered with a presence pulse.
+        STATIC_INLINE boolean_t reset()
+        {
+            Pin::setOutLow();
+            wait<480>();
+            Pin::setOutHigh();
+            wait<70>();
+            const boolean_t present = !Pin::getIn();
+            wait<410>();
+            return present;
+        }
+
+        /// @brief This method sends a byte.
+        ///
+        /// @param value The byte to send.
+        STATIC_INLINE void write(const uint8_t value)
+        {
+            for (uint32_t bit = 0; bit < 8u; bit++)
+            {
+                shiftBit((value >> bit) & 1u);
+            }
+        }
+
+        /// @brief This method reads a byte.
+        ///
+        /// @returns The received byte.
+        STATIC_INLINE uint8_t read()
+        {
+            uint8_t value = 0u;
+            for (uint32_t bit = 0; bit < 8u; bit++)
+            {
+                value |= shiftBit(1u) << bit;
+            }
+            return value;
+        }
+
+        /// @brief This method transfers a single time slot.
+        ///
+        /// @param bit The bit to send (0 or 1). A 1 is sent to read a bit.
+        /// @returns The level sampled by the master within the slot.
+        STATIC_INLINE uint32_t shiftBit(const uint32_t bit)
+        {
+            const uint32_t start = CycleCounter::now();
+            Pin::setOutLow();
+            waitUntil<6>(start);
+            Pin::setOut(bit);
+            waitUntil<15>(start);
+            const uint32_t received = Pin::getIn();
+            waitUntil<60>(start);
+            Pin::setOutHigh();
+            waitUntil<70>(start);
+            return received;
+        }
+
+    private:
+        /// Waits until the given number of microseconds passed since start.
+        template<uint32_t us>
+            STATIC_INLINE void waitUntil(const uint32_t start)
+            {
+                while (CycleCounter::now() - start < us * cyclesPerUs)
+                {
+                }
+            }
+
+        /// Waits the given number of microseconds.
+        template<uint32_t us>
+            STATIC_INLINE void wait()
+            {
+                waitUntil<us>(CycleCounter::now());
+            }
+
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        BitBangOneWire();
+    };
+
+#endif
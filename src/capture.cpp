@@ -0,0 +1,177 @@
+/// @file
+///
+/// @brief This file contains the implementation of the logic analyzer capture module.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Capture
+
+#include <stdio.h>
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "capture.h"
+
+/// Base timer TMCR: reload timer mode (FMD = 011)
+static const uint16_t BT_TMCR_RELOAD_TIMER = 0x3u << 4;
+/// Base timer TMCR: count enable
+static const uint16_t BT_TMCR_CTEN = 1u << 1;
+/// Base timer TMCR: software start trigger
+static const uint16_t BT_TMCR_STRG = 1u << 0;
+/// Base timer STC: underflow interrupt request enable
+static const uint8_t BT_STC_UDIE = 1u << 4;
+
+/// INTREQ DRQSEL: route IRQ0 of base timer 0 to the DMAC
+static const uint32_t DRQSEL_IRQ0BT0 = 1u << 8;
+
+/// DMACR: enable all channels
+static const uint32_t DMACR_DE = 1u << 31;
+/// DMACA: enable the channel
+static const uint32_t DMACA_EB = 1u << 31;
+/// DMACA: transfer request input IDREQ8 (IRQ0 of base timer 0)
+static const uint32_t DMACA_IS_IRQ0BT0 = 0x28u << 23;
+/// DMACB: half word transfers
+static const uint32_t DMACB_TW_HALFWORD = 1u << 26;
+/// DMACB: fixed source address
+static const uint32_t DMACB_FS = 1u << 25;
+/// DMACB: reload the transfer count after each pass
+static const uint32_t DMACB_RC = 1u << 23;
+/// DMACB: reload the destination address after each pass
+static const uint32_t DMACB_RD = 1u << 21;
+/// DMACB: completion interrupt enable
+static const uint32_t DMACB_CI = 1u << 19;
+/// DMACB: stop status
+static const uint32_t DMACB_SS = 0x7u << 16;
+/// DMACB: stop status of a completed pass (normal end)
+static const uint32_t DMACB_SS_NORMAL_END = 0x5u << 16;
+/// DMACB: keep the channel enabled after each pass
+static const uint32_t DMACB_EM = 1u << 0;
+
+static uint16_t buffer[CAPTURE_BUFFER_SIZE]; ///< Ring buffer which is written by the DMAC.
+static volatile uint32_t passes; ///< Number of completed passes through the ring buffer.
+static GpioPortId capturedPort; ///< The port of the last capture.
+static uint32_t capturedPeriod; ///< The sample period of the last capture.
+static uint32_t oldestSample; ///< Index of the oldest sample in the ring buffer.
+static uint32_t sampleCount; ///< Number of samples in the ring buffer.
+
+void CAPTURE_start(const GpioPortId port, const uint32_t period)
+{
+    CAPTURE_stop();
+
+    capturedPort = port;
+    capturedPeriod = period;
+    passes = 0u;
+    oldestSample = 0u;
+    sampleCount = 0u;
+
+    // The DMAC reads the input data register of the port with each request of the timer.
+    FM4_INTREQ->DRQSEL |= DRQSEL_IRQ0BT0;
+    FM4_DMAC->DMACR = DMACR_DE;
+    FM4_DMAC->DMACSA0 = FM4_GPIO_BASE + GPIO_HAL_PDIR_OFFSET + 4u * port;
+    FM4_DMAC->DMACDA0 = (uint32_t) buffer;
+    FM4_DMAC->DMACB0 = DMACB_TW_HALFWORD | DMACB_FS | DMACB_RC | DMACB_RD | DMACB_CI | DMACB_EM;
+    FM4_DMAC->DMACA0 = DMACA_EB | DMACA_IS_IRQ0BT0 | (CAPTURE_BUFFER_SIZE - 1u);
+
+    NVIC_ClearPendingIRQ(DMAC0_IRQn);
+    NVIC_EnableIRQ(DMAC0_IRQn);
+
+    // The mode must be selected before the other timer registers are written.
+    FM4_BT0_RT->TMCR = BT_TMCR_RELOAD_TIMER;
+    FM4_BT0_RT->PCSR = period - 1u;
+    FM4_BT0_RT->STC = BT_STC_UDIE;
+    FM4_BT0_RT->TMCR = BT_TMCR_RELOAD_TIMER | BT_TMCR_CTEN;
+    FM4_BT0_RT->TMCR = BT_TMCR_RELOAD_TIMER | BT_TMCR_CTEN | BT_TMCR_STRG;
+}
+
+void CAPTURE_stop()
+{
+    if ((FM4_DMAC->DMACA0 & DMACA_EB) == 0u)
+    {
+        return;
+    }
+
+    FM4_BT0_RT->TMCR = BT_TMCR_RELOAD_TIMER;
+    FM4_DMAC->DMACA0 &= ~DMACA_EB;
+    NVIC_DisableIRQ(DMAC0_IRQn);
+    FM4_INTREQ->DRQSEL &= ~DRQSEL_IRQ0BT0;
+
+    // A pass may have completed after the last ISR_Dmac0() and before the channel or its irq was
+    // disabled. The irq is not taken anymore, so the pass is counted here. When ISR_Dmac0() has run
+    // meanwhile, the stop status and the pending bit are cleared already.
+    if ((FM4_DMAC->DMACB0 & DMACB_SS) == DMACB_SS_NORMAL_END || NVIC_GetPendingIRQ(DMAC0_IRQn) != 0u)
+    {
+        FM4_DMAC->DMACB0 &= ~DMACB_SS;
+        NVIC_ClearPendingIRQ(DMAC0_IRQn);
+        passes++;
+    }
+
+    // The destination address points to the slot of the next sample.
+    const uint32_t next = (FM4_DMAC->DMACDA0 - (uint32_t) buffer) / sizeof(buffer[0]);
+    if (passes == 0u)
+    {
+        oldestSample = 0u;
+        sampleCount = next;
+    }
+    else
+    {
+        oldestSample = next % CAPTURE_BUFFER_SIZE;
+        sampleCount = CAPTURE_BUFFER_SIZE;
+    }
+}
+
+uint32_t CAPTURE_getSampleCount()
+{
+    return sampleCount;
+}
+
+uint16_t CAPTURE_getSample(const uint32_t index)
+{
+    return buffer[(oldestSample + index) % CAPTURE_BUFFER_SIZE];
+}
+
+void CAPTURE_dumpVcd(const uint32_t pinMask)
+{
+    // Each pin is identified by a single printable character, starting with '!'.
+    printf("$timescale 1 ns $end\n");
+    printf("$scope module P%X $end\n", (unsigned) capturedPort);
+    for (uint32_t pin = 0; pin < 16u; pin++)
+    {
+        if ((pinMask & (1u << pin)) != 0u)
+        {
+            printf("$var wire 1 %c P%X%X $end\n", '!' + pin, (unsigned) capturedPort, (unsigned) pin);
+        }
+    }
+    printf("$upscope $end\n$enddefinitions $end\n");
+
+    uint32_t previous = ~CAPTURE_getSample(0u); // all pins are dumped with the first sample
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        const uint32_t sample = CAPTURE_getSample(i);
+        uint32_t changed = (sample ^ previous) & pinMask;
+        previous = sample;
+        if (changed == 0u)
+        {
+            continue;
+        }
+
+        const uint64_t ns = ((uint64_t) i * capturedPeriod * 1000000000ull) / CAPTURE_TIMER_CLOCK;
+        printf("#%lu\n", (unsigned long) ns);
+        while (changed != 0u)
+        {
+            const uint32_t pin = 31u - __CLZ(changed);
+            changed &= ~(1u << pin);
+            printf("%c%c\n", ((sample >> pin) & 1u) ? '1' : '0', '!' + pin);
+        }
+    }
+    printf("#%lu\n", (unsigned long) (((uint64_t) sampleCount * capturedPeriod * 1000000000ull) / CAPTURE_TIMER_CLOCK));
+}
+
+/// @brief DMAC channel 0 interrupt service routine
+///
+/// It is raised after each pass through the ring buffer.
+///
+/// @attention C Linkage is required for all interrupt service routines.
+extern "C" void ISR_Dmac0()
+{
+    FM4_DMAC->DMACB0 &= ~DMACB_SS;
+    passes++;
+}
@@ -0,0 +1,76 @@
+/// @file
+///
+/// @brief This file contains the logic analyzer capture module.
+///
+/// The capture module samples the input data register (PDIR) of a gpio port at a fixed rate
+/// without any cpu involvement:
+///
+/// * Base timer 0 runs as reload timer. Each underflow raises its IRQ0 request.
+/// * The request is routed to the DMAC instead of the nvic (DRQSEL register of the INTREQ block).
+/// * DMAC channel 0 copies PDIR into a ring buffer in ram. The transfer count and the destination
+///   address are reloaded after each pass, so the capture runs until it is stopped.
+///
+/// The samples are written to stdout as value change dump (VCD). The output can be stored
+/// in a file and opened with a waveform viewer like GTKWave.
+///
+/// @attention The capture module uses base timer 0 and DMAC channel 0 exclusively.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Capture
+
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "gpio.h"
+
+/// @brief This module contains the logic analyzer capture mode.
+///
+/// @defgroup Capture Logic Analyzer Capture
+
+/// Number of samples the ring buffer can hold. Each sample takes two bytes.
+/// @ingroup Capture
+#define CAPTURE_BUFFER_SIZE 1024
+
+/// Clock of the base timer in Hz. The base timers are connected to APB1.
+/// @ingroup Capture
+#define CAPTURE_TIMER_CLOCK (__HCLK >> (APBC1_PSR_Val & 0x3ul))
+
+/// @brief This function starts a capture. A running capture is stopped and its samples are discarded.
+///
+/// The sample rate is CAPTURE_TIMER_CLOCK / period. The DMAC needs a few bus cycles per sample.
+/// Periods below approximately 10 cycles are not sustained.
+///
+/// @param port The port whose pins are sampled.
+/// @param period The sample period in cycles of the base timer clock (2 - 65536).
+/// @ingroup Capture
+void CAPTURE_start(const GpioPortId port, const uint32_t period);
+
+/// @brief This function stops the running capture. The samples stay in the ring buffer.
+/// @ingroup Capture
+void CAPTURE_stop();
+
+/// @brief This function returns the number of samples in the ring buffer.
+///
+/// @returns The number of samples (0 - CAPTURE_BUFFER_SIZE).
+/// @ingroup Capture
+uint32_t CAPTURE_getSampleCount();
+
+/// @brief This function returns a sample of the ring buffer.
+///
+/// @param index The index of the sample. 0 is the oldest sample.
+/// @returns The sampled PDIR register.
+/// @ingroup Capture
+uint16_t CAPTURE_getSample(const uint32_t index);
+
+/// @brief This function writes the samples of the stopped capture to stdout as value change dump.
+///
+/// Each selected pin is dumped as a wire named after the pin (e.g. P1A). Only changes are written.
+///
+/// @param pinMask The pins of the port which are dumped.
+/// @ingroup Capture
+void CAPTURE_dumpVcd(const uint32_t pinMask);
+
+#endif
@@ -0,0 +1,172 @@
+/// @file
+///
+/// @brief This file contains the vertical counter debouncer.
+///
+/// The debouncer reads a whole port with a single access and debounces all inputs of the port in
+/// parallel. Each input owns a 2 bit counter. The counters are stored bit sliced in two 32 bit
+/// words ("vertical counters"), so one tick costs a handful of logical operations per port,
+/// independent of the number of inputs.
+///
+/// An input changes its debounced state after DEBOUNCER_SAMPLES consecutive samples which differ
+/// from the actual state. A single matching sample resets its counter. With a 1 ms tick a contact
+/// has to be stable for 4 ms.
+///
+/// The debouncers are intended to be sampled from SysTickController::isr(). The press and release
+/// edges are latched until they are taken from thread mode.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Debouncer
+
+#ifndef __DEBOUNCER_H__
+#define __DEBOUNCER_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "gpio.h"
+#include "utils.h"
+
+/// @brief This module contains the vertical counter debouncer.
+///
+/// @defgroup Debouncer Debouncer
+
+/// Number of consecutive equal samples after which an input changes its debounced state.
+/// It is fixed by the width of the vertical counters (2 bits).
+/// @ingroup Debouncer
+#define DEBOUNCER_SAMPLES 4
+
+/// @brief This class debounces up to 32 inputs in parallel.
+///
+/// A set bit of the sample means that the input is active (pressed). Inversion of active low
+/// inputs is done by the caller (see PortDebouncer).
+///
+/// @ingroup Debouncer
+struct VerticalDebouncer
+{
+    /// @brief Constructor
+    ///
+    /// @param initial The initial debounced state. No edges are reported for it.
+    VerticalDebouncer(const uint32_t initial = 0u) :
+            count0(0u), count1(0u), state(initial), presses(0u), releases(0u)
+    {
+    }
+
+    /// @brief This method feeds a new sample into the debouncer.
+    ///
+    /// The counter of each input which differs from its debounced state is incremented. All other
+    /// counters are reset. An input whose counter overflows toggles its debounced state.
+    ///
+    /// @attention It must not be called from more than one context.
+    ///
+    /// @param sample The actual state of all inputs.
+    /// @returns The mask of all inputs which changed their debounced state.
+    INLINE uint32_t update(const uint32_t sample)
+    {
+        const uint32_t delta = sample ^ state;
+        const uint32_t toggle = delta & count1 & count0;
+
+        count1 = (count1 ^ count0) & delta;
+        count0 = ~count0 & delta;
+        state ^= toggle;
+
+        presses |= toggle & state;
+        releases |= toggle & ~state;
+        return toggle;
+    }
+
+    /// @brief This method returns the debounced state of all inputs.
+    INLINE uint32_t getState() const
+    {
+        return state;
+    }
+
+    /// @brief This method returns and clears the latched press edges.
+    ///
+    /// It can be called from thread mode while update() is called from an isr. No edge is lost.
+    ///
+    /// @returns The mask of all inputs which were pressed since the last call.
+    INLINE uint32_t takePresses()
+    {
+        return take(&presses);
+    }
+
+    /// @brief This method returns and clears the latched release edges.
+    ///
+    /// It can be called from thread mode while update() is called from an isr. No edge is lost.
+    ///
+    /// @returns The mask of all inputs which were released since the last call.
+    INLINE uint32_t takeReleases()
+    {
+        return take(&releases);
+    }
+
+private:
+    /// Atomically reads and clears a latched edge mask. The store fails and is retried when
+    /// an isr ran between the load and the store.
+    STATIC_INLINE uint32_t take(volatile uint32_t* edges)
+    {
+        uint32_t value;
+        do
+        {
+            value = __LDREXW(edges);
+        } while (__STREXW(0u, edges) != 0u);
+        return value;
+    }
+
+    uint32_t count0; ///< Bit 0 of the counters of all inputs
+    uint32_t count1; ///< Bit 1 of the counters of all inputs
+    uint32_t state; ///< Debounced state of all inputs
+    volatile uint32_t presses; ///< Latched press edges. Written by update(), cleared by takePresses().
+    volatile uint32_t releases; ///< Latched release edges. Written by update(), cleared by takeReleases().
+};
+
+/// @brief This class template debounces the inputs of a single gpio port.
+///
+/// The input data register of the port is read once per sample() call.
+///
+/// @tparam portId The port identifier.
+/// @tparam inputMask The pins of the port which are debounced. All other pins are reported as released.
+/// @tparam activeLowMask The pins which are active (pressed) when they are low, e.g. buttons with pull-up.
+/// @ingroup Debouncer
+template<GpioPortId portId, uint32_t inputMask, uint32_t activeLowMask = 0u>
+    struct PortDebouncer : public VerticalDebouncer
+    {
+        /// Constructor. All inputs start released.
+        PortDebouncer()
+        {
+        }
+
+        /// @brief This method reads the port and feeds it into the debouncer.
+        ///
+        /// @returns The mask of all pins which changed their debounced state.
+        INLINE uint32_t sample()
+        {
+            return update((GpioPort<portId>::read() ^ activeLowMask) & inputMask);
+        }
+
+    private:
+        static_assert(inputMask != 0u, "A port debouncer needs at least one input");
+        static_assert((activeLowMask & ~inputMask) == 0u, "Active low pins must be inputs");
+    };
+
+/// @cond TEMPLATE_DOC
+
+STATIC_INLINE void DEBOUNCER_sample()
+{
+}
+/// @endcond
+
+/// @brief This function samples any number of port debouncers.
+///
+/// It is intended to be called once per tick, e.g. DEBOUNCER_sample(buttons, contacts).
+///
+/// @param debouncer The first debouncer.
+/// @param others All other debouncers.
+/// @ingroup Debouncer
+template<class Debouncer, class... Debouncers>
+    STATIC_INLINE void DEBOUNCER_sample(Debouncer& debouncer, Debouncers&... others)
+    {
+        debouncer.sample();
+        DEBOUNCER_sample(others...);
+    }
+
+#endif
@@ -0,0 +1,91 @@
+/// @file
+///
+/// @brief This file contains the implementation of the deferred work module.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Defer
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "defer.h"
+#include "isr.h"
+
+/// This struct describes a single work item.
+struct DeferItem
+{
+    DeferFunction volatile function; ///< The function. NULL while the slot is free or being written.
+    uint32_t argument; ///< The argument of the function.
+};
+
+static DeferItem queue[DEFER_QUEUE_SIZE]; ///< The work items.
+static volatile uint32_t head; ///< Number of claimed slots. Written by the producers.
+static volatile uint32_t tail; ///< Number of executed items. Written by the PendSV routine only.
+static volatile uint32_t droppedItems; ///< Number of items lost because the queue was full.
+
+/// @brief Executes all complete items in the order in which they were posted.
+///
+/// It stops at a claimed slot whose item is not complete yet. The producer of that item
+/// pends PendSV again after the item was written.
+static INLINE void drain()
+{
+    uint32_t index = tail;
+    DeferItem* item = &queue[index & (DEFER_QUEUE_SIZE - 1u)];
+    DeferFunction function;
+
+    while ((function = item->function) != NULL)
+    {
+        const uint32_t argument = item->argument;
+        item->function = NULL;
+        __DMB(); // the slot must be free before it is released to the producers
+        tail = ++index;
+
+        function(argument);
+        item = &queue[index & (DEFER_QUEUE_SIZE - 1u)];
+    }
+}
+
+/// The PendSV interrupt service routine. It is installed when the kernel is not used.
+static INLINE ReturnCode handlePendSv()
+{
+    drain();
+    return RC_OK;
+}
+
+void DEFER_init()
+{
+    IsrBinding<&handlePendSv>::install(PendSV_IRQn);
+}
+
+extern "C" void DEFER_drain()
+{
+    drain();
+}
+
+boolean_t DEFER_post(DeferFunction function, const uint32_t argument)
+{
+    uint32_t index;
+    do
+    {
+        index = __LDREXW(&head);
+        if (index - tail >= DEFER_QUEUE_SIZE)
+        {
+            __CLREX();
+            droppedItems++;
+            return FALSE;
+        }
+    } while (__STREXW(index + 1u, &head) != 0u);
+
+    DeferItem& item = queue[index & (DEFER_QUEUE_SIZE - 1u)];
+    item.argument = argument;
+    __DMB(); // the argument must be written before the item is marked as complete
+    item.function = function;
+
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    return TRUE;
+}
+
+uint32_t DEFER_getDroppedItems()
+{
+    return droppedItems;
+}
@@ -0,0 +1,81 @@
+/// @file
+///
+/// @brief This file contains the deferred work module.
+///
+/// An interrupt service routine should only do the work which cannot wait: read the data, clear the
+/// request and restart the peripheral. Everything else can be posted as a work item:
+///
+/// @code
+/// static void processFrame(const uint32_t length)
+/// {
+///     ... // runs at the lowest exception priority
+/// }
+///
+/// extern "C" void ISR_xxx()
+/// {
+///     ... // acknowledge the peripheral
+///     DEFER_post(&processFrame, length);
+/// }
+/// @endcode
+///
+/// DEFER_post() writes the item into a queue and pends the PendSV exception. PendSV has the lowest
+/// priority. It is taken when no other interrupt service routine is active, before the cpu returns
+/// to thread mode. The PendSV routine executes all queued items in the order in which they were posted.
+///
+/// The queue is lock free. Items can be posted from thread mode and from interrupt service routines
+/// of any priority. A slot is claimed with ldrex/strex. The function pointer of an item is written
+/// last, it marks the item as complete.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Defer
+
+#ifndef __DEFER_H__
+#define __DEFER_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+
+/// @brief This module contains the deferred work queue.
+///
+/// @defgroup Defer Deferred Work
+
+/// Number of work items the queue can hold. Must be a power of two.
+/// @ingroup Defer
+#define DEFER_QUEUE_SIZE 32
+
+/// Type of the function of a work item.
+/// @ingroup Defer
+typedef void (*DeferFunction)(const uint32_t argument);
+
+/// @brief This function installs the PendSV interrupt service routine.
+///
+/// It must be called before the first item is posted. PendSV has the lowest priority (see priority.h).
+/// @ingroup Defer
+void DEFER_init();
+
+/// @brief This function executes all queued work items.
+///
+/// It is called by the PendSV routine. The kernel replaces the PendSV routine with its context
+/// switch, which calls this function first (see kernel.h).
+///
+/// @attention C Linkage is required, because the function is called from assembler.
+/// @ingroup Defer
+extern "C" void DEFER_drain();
+
+/// @brief This function posts a work item.
+///
+/// The item is executed by the PendSV routine after all active interrupt service routines have
+/// returned. Items which are posted while the queue is drained are executed in the same run.
+///
+/// @param function The function which is executed.
+/// @param argument The argument which is passed to the function.
+/// @returns TRUE when the item was queued, FALSE when the queue is full.
+/// @ingroup Defer
+boolean_t DEFER_post(DeferFunction function, const uint32_t argument);
+
+/// @brief This function returns the number of items which were dropped, because the queue was full.
+/// @ingroup Defer
+uint32_t DEFER_getDroppedItems();
+
+#endif
@@ -0,0 +1,145 @@
+/// @file
+///
+/// @brief This file contains the implementation of the event loop.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup EventLoop
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "cycle_counter.h"
+#include "event_loop.h"
+#include "systick.h"
+
+static EventHandler handlers[EVENT_COUNT]; ///< The handlers of the events.
+static volatile uint32_t pendingEvents; ///< Bit x is set when event x was posted.
+static volatile uint32_t postTimestamp; ///< Value of the cycle counter when the first pending event was posted.
+
+static EventStatistics statistics; ///< Statistics of the event loop.
+static uint32_t awakeSince; ///< Systick time when the core woke up the last time.
+static boolean_t running; ///< TRUE when awakeSince is valid.
+
+void EVENT_setHandler(const uint8_t event, EventHandler handler)
+{
+    handlers[event] = handler;
+}
+
+void EVENT_post(const uint8_t event)
+{
+    const uint32_t timestamp = CycleCounter::now();
+    uint32_t events;
+    do
+    {
+        events = __LDREXW(&pendingEvents);
+    } while (__STREXW(events | (1u << event), &pendingEvents) != 0u);
+
+    if (events == 0u)
+    {
+        postTimestamp = timestamp;
+    }
+
+    // Thread mode must resume to execute the handler.
+    SCB->SCR &= ~SCB_SCR_SLEEPONEXIT_Msk;
+}
+
+boolean_t EVENT_dispatch()
+{
+    if (pendingEvents == 0u)
+    {
+        return FALSE;
+    }
+
+    const uint32_t latency = CycleCounter::now() - postTimestamp;
+    statistics.lastWakeLatency = latency;
+    if (latency > statistics.maxWakeLatency)
+    {
+        statistics.maxWakeLatency = latency;
+    }
+
+    uint32_t events;
+    do
+    {
+        events = __LDREXW(&pendingEvents);
+    } while (__STREXW(0u, &pendingEvents) != 0u);
+
+    while (events != 0u)
+    {
+        const uint8_t event = 31u - __CLZ(events);
+        events &= ~(1u << event);
+
+        if (handlers[event] != NULL)
+        {
+            handlers[event]();
+        }
+    }
+    return TRUE;
+}
+
+void EVENT_step(const boolean_t sleepOnExit)
+{
+    EVENT_dispatch();
+
+    // With interrupts disabled the check of the events and wfi are atomic. A pending irq
+    // wakes the core up, but it is only taken after the interrupts are enabled again.
+    __disable_irq();
+    const uint32_t sleepStart = SysTickController::getCycles();
+    if (running)
+    {
+        statistics.awakeCycles += sleepStart - awakeSince;
+    }
+
+    if (pendingEvents == 0u)
+    {
+        if (sleepOnExit)
+        {
+            SCB->SCR |= SCB_SCR_SLEEPONEXIT_Msk;
+            __DSB();
+            __WFI();
+        }
+        else
+        {
+#ifdef ENABLE_TICKLESS_IDLE
+            statistics.suppressedTicks += SysTickController::idle();
+#else
+            __DSB();
+            __WFI();
+#endif
+        }
+        statistics.sleeps++;
+    }
+
+    awakeSince = SysTickController::getCycles();
+    statistics.sleepCycles += awakeSince - sleepStart;
+    running = TRUE;
+    __enable_irq();
+}
+
+void EVENT_run(const boolean_t sleepOnExit)
+{
+    while (1)
+    {
+        EVENT_step(sleepOnExit);
+    }
+}
+
+void EVENT_getStatistics(EventStatistics& result)
+{
+    // The statistics are only written in thread mode.
+    result = statistics;
+}
+
+uint32_t EVENT_getSleepPermille()
+{
+    EventStatistics actual;
+    EVENT_getStatistics(actual);
+
+    const uint64_t total = actual.sleepCycles + actual.awakeCycles;
+    return (total != 0u) ? (uint32_t) (actual.sleepCycles * 1000u / total) : 0u;
+}
+
+void EVENT_resetStatistics()
+{
+    statistics = EventStatistics();
+    running = FALSE;
+}
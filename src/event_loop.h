@@ -0,0 +1,132 @@
+/// @file
+///
+/// @brief This file contains the event loop.
+///
+/// Interrupt service routines signal work to thread mode with event flags. The event loop executes
+/// the handlers of all posted events in thread mode and puts the core to sleep with wfi when no
+/// event is pending:
+///
+/// @code
+/// static void onFrame()
+/// {
+///     ... // thread mode
+/// }
+///
+/// extern "C" void ISR_xxx()
+/// {
+///     ... // acknowledge the peripheral
+///     EVENT_post(EVENT_FRAME);
+/// }
+///
+/// int main()
+/// {
+///     EVENT_setHandler(EVENT_FRAME, &onFrame);
+///     EVENT_run(FALSE);
+/// }
+/// @endcode
+///
+/// The pending events are checked with interrupts disabled right before wfi. An irq which is raised
+/// in between wakes the core up immediately, so an event can never be missed.
+///
+/// With SLEEPONEXIT the core goes back to sleep directly at the end of each interrupt service
+/// routine. Thread mode only resumes when an event was posted. This saves the exception return
+/// and the loop iteration for routines which do not post events (e.g. the software pwm).
+///
+/// Without SLEEPONEXIT the loop sleeps tickless when the macro ENABLE_TICKLESS_IDLE is defined (see
+/// Makefile): the systick irqs are suppressed until the next tick in which a subscriber has work
+/// (see SysTickController::idle()).
+///
+/// The loop measures the time spent sleeping with the systick (see SysTickController::getCycles())
+/// and the wake latency with the dwt cycle counter.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup EventLoop
+
+#ifndef __EVENT_LOOP_H__
+#define __EVENT_LOOP_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+
+/// @brief This module contains the event loop.
+///
+/// @defgroup EventLoop Event Loop
+
+/// Number of events.
+/// @ingroup EventLoop
+#define EVENT_COUNT 32
+
+/// Type of the handler of an event. It is executed in thread mode.
+/// @ingroup EventLoop
+typedef void (*EventHandler)();
+
+/// This struct contains the statistics of the event loop.
+/// @ingroup EventLoop
+struct EventStatistics
+{
+    uint64_t sleepCycles; ///< Cycles spent in wfi.
+    uint64_t awakeCycles; ///< Cycles spent outside of wfi, including the interrupt service routines.
+    uint32_t sleeps; ///< Number of executed wfi instructions.
+    uint32_t suppressedTicks; ///< Number of systick irqs which were suppressed by the tickless idle.
+    uint32_t lastWakeLatency; ///< Cycles from the post of an event to the start of the handlers. Measured for the first event after the loop was idle.
+    uint32_t maxWakeLatency; ///< The longest wake latency in cycles.
+};
+
+/// @brief This function sets the handler of an event.
+///
+/// @param event The event (0 - EVENT_COUNT - 1).
+/// @param handler The handler. NULL ignores the event.
+/// @ingroup EventLoop
+void EVENT_setHandler(const uint8_t event, EventHandler handler);
+
+/// @brief This function posts an event. It can be called from any interrupt service routine and from thread mode.
+///
+/// The handler of the event is executed once, even when the event is posted several times before.
+///
+/// @param event The event (0 - EVENT_COUNT - 1).
+/// @ingroup EventLoop
+void EVENT_post(const uint8_t event);
+
+/// @brief This function executes the handlers of all pending events.
+///
+/// The events with a higher number are executed first.
+///
+/// @returns TRUE when at least one handler was executed.
+/// @ingroup EventLoop
+boolean_t EVENT_dispatch();
+
+/// @brief This function executes one iteration of the event loop.
+///
+/// The handlers of all pending events are executed. Then the core sleeps until an irq is raised,
+/// unless an event was posted meanwhile. The iteration ends after the irq was handled.
+///
+/// @param sleepOnExit TRUE when the core should go back to sleep after each interrupt service
+/// routine which did not post an event. The time spent in these sleeps is counted as awake time.
+/// The tickless idle is not used in this mode.
+/// @ingroup EventLoop
+void EVENT_step(const boolean_t sleepOnExit);
+
+/// @brief This function runs the event loop. It does not return.
+///
+/// @param sleepOnExit See EVENT_step().
+/// @ingroup EventLoop
+void EVENT_run(const boolean_t sleepOnExit);
+
+/// @brief This function returns the statistics of the event loop. It must be called from thread mode.
+///
+/// @param statistics The statistics are written to this reference.
+/// @ingroup EventLoop
+void EVENT_getStatistics(EventStatistics& statistics);
+
+/// @brief This function returns the fraction of the time spent sleeping. It must be called from thread mode.
+///
+/// @returns The fraction in 1/1000.
+/// @ingroup EventLoop
+uint32_t EVENT_getSleepPermille();
+
+/// @brief This function clears the statistics of the event loop. It must be called from thread mode.
+/// @ingroup EventLoop
+void EVENT_resetStatistics();
+
+#endif
@@ -0,0 +1,247 @@
+/// @file
+///
+/// @brief This file contains the implementation of the external interrupt (EXINT) module.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Exint
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "cycle_counter.h"
+#include "exint.h"
+#include "isr.h"
+
+static IInterruptServiceRoutine* handlers[EXINT_CHANNELS]; ///< Registered interrupt service routines. NULL selects the queue.
+static volatile uint32_t timestamps[EXINT_CHANNELS]; ///< Timestamps of the last event of each channel.
+
+static ExintEvent queue[EXINT_QUEUE_SIZE]; ///< Event queue which is written by the isrs and read by thread mode.
+static volatile uint32_t queueHead; ///< Number of events written to the queue. Only changed by the isrs.
+static volatile uint32_t queueTail; ///< Number of events read from the queue. Only changed by thread mode.
+static volatile uint32_t droppedEvents; ///< Number of events lost because the queue was full.
+
+/// Returns the nvic irq of a channel.
+static IRQn_Type getIrq(const uint8_t channel)
+{
+    if (channel < 8u)
+    {
+        return (IRQn_Type) (EXINT0_IRQn + channel);
+    }
+    else if (channel < 16u)
+    {
+        return (IRQn_Type) (EXINT8_IRQn + channel - 8u);
+    }
+    else
+    {
+        return (IRQn_Type) (EXINT16_19_IRQn + (channel - 16u) / 4u);
+    }
+}
+
+void EXINT_enable(const uint8_t channel, const ExintTrigger trigger)
+{
+    const uint32_t mask = 1u << channel;
+    const uint32_t shift = 2u * (channel % 16u);
+
+    // The trigger must only be changed while the channel is disabled. Otherwise a spurious irq can occur.
+    FM4_EXTI_ENIR &= ~mask;
+    if (channel < 16u)
+    {
+        FM4_EXTI_ELVR = (FM4_EXTI_ELVR & ~(3u << shift)) | ((uint32_t) trigger << shift);
+    }
+    else
+    {
+        FM4_EXTI_ELVR1 = (FM4_EXTI_ELVR1 & ~(3u << shift)) | ((uint32_t) trigger << shift);
+    }
+    FM4_EXTI_EICL = ~mask; // writing 0 clears the request, writing 1 has no effect
+    FM4_EXTI_ENIR |= mask;
+
+    NVIC_ClearPendingIRQ(getIrq(channel));
+    NVIC_EnableIRQ(getIrq(channel));
+}
+
+void EXINT_disable(const uint8_t channel)
+{
+    FM4_EXTI_ENIR &= ~(1u << channel);
+    // The irqs of the channels 16 to 31 are shared. They stay enabled in the nvic. Without
+    // an enabled channel they are never raised.
+    if (channel < 16u)
+    {
+        NVIC_DisableIRQ(getIrq(channel));
+    }
+}
+
+void EXINT_registerIsr(const uint8_t channel, IInterruptServiceRoutine* isr)
+{
+    handlers[channel] = isr;
+}
+
+uint32_t EXINT_getTimestamp(const uint8_t channel)
+{
+    return timestamps[channel];
+}
+
+boolean_t EXINT_popEvent(ExintEvent* event)
+{
+    const uint32_t tail = queueTail;
+    if (tail == queueHead)
+    {
+        return FALSE;
+    }
+    *event = queue[tail & (EXINT_QUEUE_SIZE - 1u)];
+    __DMB(); // the event must be read before the slot is released
+    queueTail = tail + 1u;
+    return TRUE;
+}
+
+uint32_t EXINT_getDroppedEvents()
+{
+    return droppedEvents;
+}
+
+/// @brief Handles all pending requests of the given channels.
+///
+/// The requests are cleared with a single write before the events are delivered. The
+/// pending channels are processed from the highest to the lowest channel.
+///
+/// @param timestamp The value of the cycle counter at the entry of the interrupt service routine.
+/// @param channels The channels which are served by the calling interrupt service routine.
+static INLINE void handleChannels(const uint32_t timestamp, const uint32_t channels)
+{
+    uint32_t pending = FM4_EXTI_EIRR & FM4_EXTI_ENIR & channels;
+    FM4_EXTI_EICL = ~pending;
+
+    while (pending != 0u)
+    {
+        const uint8_t channel = 31u - __CLZ(pending);
+        pending &= ~(1u << channel);
+
+        timestamps[channel] = timestamp;
+        if (handlers[channel] != NULL)
+        {
+            handlers[channel]->isr();
+        }
+        else
+        {
+            const uint32_t head = queueHead;
+            if (head - queueTail < EXINT_QUEUE_SIZE)
+            {
+                queue[head & (EXINT_QUEUE_SIZE - 1u)].timestamp = timestamp;
+                queue[head & (EXINT_QUEUE_SIZE - 1u)].channel = channel;
+                __DMB(); // the event must be written before it is published
+                queueHead = head + 1u;
+            }
+            else
+            {
+                droppedEvents++;
+            }
+        }
+    }
+}
+
+/// @brief External interrupt service routines
+///
+/// The channels 0 to 15 have their own irq. The channels 16 to 31 share one irq per four channels.
+/// Each routine samples the cycle counter before anything else is done.
+///
+/// @attention C Linkage is required for all interrupt service routines.
+/// @{
+extern "C" void ISR_Exint0()
+{
+    handleChannels(CycleCounter::now(), 1u << 0);
+}
+
+extern "C" void ISR_Exint1()
+{
+    handleChannels(CycleCounter::now(), 1u << 1);
+}
+
+extern "C" void ISR_Exint2()
+{
+    handleChannels(CycleCounter::now(), 1u << 2);
+}
+
+extern "C" void ISR_Exint3()
+{
+    handleChannels(CycleCounter::now(), 1u << 3);
+}
+
+extern "C" void ISR_Exint4()
+{
+    handleChannels(CycleCounter::now(), 1u << 4);
+}
+
+extern "C" void ISR_Exint5()
+{
+    handleChannels(CycleCounter::now(), 1u << 5);
+}
+
+extern "C" void ISR_Exint6()
+{
+    handleChannels(CycleCounter::now(), 1u << 6);
+}
+
+extern "C" void ISR_Exint7()
+{
+    handleChannels(CycleCounter::now(), 1u << 7);
+}
+
+extern "C" void ISR_Exint8()
+{
+    handleChannels(CycleCounter::now(), 1u << 8);
+}
+
+extern "C" void ISR_Exint9()
+{
+    handleChannels(CycleCounter::now(), 1u << 9);
+}
+
+extern "C" void ISR_Exint10()
+{
+    handleChannels(CycleCounter::now(), 1u << 10);
+}
+
+extern "C" void ISR_Exint11()
+{
+    handleChannels(CycleCounter::now(), 1u << 11);
+}
+
+extern "C" void ISR_Exint12()
+{
+    handleChannels(CycleCounter::now(), 1u << 12);
+}
+
+extern "C" void ISR_Exint13()
+{
+    handleChannels(CycleCounter::now(), 1u << 13);
+}
+
+extern "C" void ISR_Exint14()
+{
+    handleChannels(CycleCounter::now(), 1u << 14);
+}
+
+extern "C" void ISR_Exint15()
+{
+    handleChannels(CycleCounter::now(), 1u << 15);
+}
+
+extern "C" void ISR_Exint16_19()
+{
+    handleChannels(CycleCounter::now(), 0xFu << 16);
+}
+
+extern "C" void ISR_Exint20_23()
+{
+    handleChannels(CycleCounter::now(), 0xFu << 20);
+}
+
+extern "C" void ISR_Exint24_27()
+{
+    handleChannels(CycleCounter::now(), 0xFu << 24);
+}
+
+extern "C" void ISR_Exint28_31()
+{
+    handleChannels(CycleCounter::now(), 0xFu << 28);
+}
+/// @}
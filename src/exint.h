@@ -0,0 +1,142 @@
+/// @file
+///
+/// @brief This file contains the external interrupt (EXINT) module.
+///
+/// An external interrupt channel raises an irq on a level or an edge of an input pin. The cycle
+/// counter is sampled as the first action of the interrupt service routine. Together with the
+/// interrupt latency this gives a timestamp of the edge with cycle resolution.
+///
+/// Each event is delivered in one of two ways:
+///
+/// * When an IInterruptServiceRoutine is registered for the channel, its isr() method is called.
+///   The timestamp of the event can be read with EXINT_getTimestamp().
+/// * Otherwise the event is put into a queue. The queue is read from thread mode with EXINT_popEvent().
+///
+/// @attention All EXINT irqs must have the same priority. The queue relies on the fact that the
+/// EXINT interrupt service routines do not preempt each other.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Exint
+
+#ifndef __EXINT_H__
+#define __EXINT_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "gpio.h"
+#include "isr.h"
+#include "utils.h"
+
+/// @brief This module contains everything related to external interrupts.
+///
+/// @defgroup Exint External Interrupts
+
+/// Number of external interrupt channels.
+/// @ingroup Exint
+#define EXINT_CHANNELS 32
+
+/// Number of events the queue can hold. Must be a power of two.
+/// @ingroup Exint
+#define EXINT_QUEUE_SIZE 16
+
+/// This enum lists all conditions which raise an external interrupt. The value equals
+/// the LBx:LAx bits in the ELVR registers.
+/// @ingroup Exint
+enum ExintTrigger
+{
+    EXINT_LOW_LEVEL = 0,    ///< The irq is raised as long as the pin is low
+    EXINT_HIGH_LEVEL = 1,   ///< The irq is raised as long as the pin is high
+    EXINT_RISING_EDGE = 2,  ///< The irq is raised on a rising edge
+    EXINT_FALLING_EDGE = 3  ///< The irq is raised on a falling edge
+};
+
+/// This struct describes a single external interrupt event.
+/// @ingroup Exint
+struct ExintEvent
+{
+    uint32_t timestamp; ///< Value of the cycle counter at the entry of the interrupt service routine.
+    uint8_t channel; ///< The channel which raised the event.
+};
+
+/// @brief This function enables an external interrupt channel.
+///
+/// The irq of the channel is enabled in the nvic as well. The channels 16 to 31 share
+/// one irq per four channels.
+///
+/// @param channel The channel (0 - 31).
+/// @param trigger The condition which raises the irq.
+/// @ingroup Exint
+void EXINT_enable(const uint8_t channel, const ExintTrigger trigger);
+
+/// @brief This function disables an external interrupt channel.
+///
+/// @param channel The channel (0 - 31).
+/// @ingroup Exint
+void EXINT_disable(const uint8_t channel);
+
+/// @brief This function registers an object which implements the IInterruptServiceRoutine interface.
+///
+/// After successful registration the method isr() of the given object is called each time
+/// the channel raises an event. Events of this channel are no longer put into the queue.
+///
+/// @param channel The channel (0 - 31).
+/// @param isr The object to call or NULL to put the events of this channel into the queue.
+/// @ingroup Exint
+void EXINT_registerIsr(const uint8_t channel, IInterruptServiceRoutine* isr);
+
+/// @brief This function returns the timestamp of the last event of a channel.
+///
+/// It is intended to be called from the registered isr() method.
+///
+/// @param channel The channel (0 - 31).
+/// @returns The value of the cycle counter at the entry of the interrupt service routine.
+/// @ingroup Exint
+uint32_t EXINT_getTimestamp(const uint8_t channel);
+
+/// @brief This function takes the oldest event out of the queue.
+///
+/// It must only be called from thread mode.
+///
+/// @param event The event is written to this object.
+/// @returns TRUE when an event was taken out of the queue, FALSE when the queue is empty.
+/// @ingroup Exint
+boolean_t EXINT_popEvent(ExintEvent* event);
+
+/// @brief This function returns the number of events which were lost because the queue was full.
+/// @ingroup Exint
+uint32_t EXINT_getDroppedEvents();
+
+/// @brief This template function binds a pin to an external interrupt channel and enables the channel.
+///
+/// The pin is passed to the peripheral function and selected as input of the channel through the
+/// EINTxxS bits of the EPFR06/EPFR15 registers. Which pin can be used with which channel and selection
+/// value is listed in the pin function list of the data sheet (INTxx_0, INTxx_1 ...).
+///
+/// @tparam pinId The pin identifier.
+/// @tparam channel The channel (0 - 31).
+/// @tparam select The value of the EINTxxS bits which selects the pin.
+/// @param trigger The condition which raises the irq.
+/// @ingroup Exint
+template<GpioPinId pinId, uint8_t channel, uint32_t select>
+    STATIC_INLINE void EXINT_bind(const ExintTrigger trigger)
+    {
+        static_assert(channel < EXINT_CHANNELS, "Invalid external interrupt channel");
+        static_assert(select <= 3u, "Invalid EINTxxS selection");
+
+        GpioPin<pinId>::init(GPIO_PERIPHERAL);
+
+        const uint32_t shift = 2u * (channel % 16u);
+        if (channel < 16u)
+        {
+            FM4_GPIO_EPFR06 = (FM4_GPIO_EPFR06 & ~(3u << shift)) | (select << shift);
+        }
+        else
+        {
+            FM4_GPIO_EPFR15 = (FM4_GPIO_EPFR15 & ~(3u << shift)) | (select << shift);
+        }
+
+        EXINT_enable(channel, trigger);
+    }
+
+#endif
@@ -15,11 +15,377 @@
 
 /// @brief This module contains everything related to gpios.
 ///
-/// The class GpioPin is the base class to all GpioHardwarePin classes. The GpioHardwarePin
-/// classes do the actual hardware accesses.
+/// There are two ways to access a gpio pin:
+///
+/// * GpioPin - A static access object. Its pin is known at compile time, therefore each method
+///   resolves to the bare hardware access (e.g. a single bit-band store). This is the preferred
+///   way to access pins from drivers and interrupt service routines.
+/// * IGpioPin - A type erased interface. It is implemented by GpioHardwarePin and GpioDummyPin. Each
+///   call is dispatched through a vtable. Use it only when the pin must be selected at runtime.
+///
+/// Multiple pins of the same port are changed with a single access to the port output register
+/// through the static access objects GpioPort, GpioPinGroup and GpioPins.
 ///
 /// @defgroup Gpio General Purpose Input Output
 
+/// This template class is a static access object to a gpio pin. It contains only static methods
+/// which are resolved at compile time. No object must be created to access the pin.
+///
+/// @tparam pinId The pin identifier.
+/// @ingroup Gpio
+template<GpioPinId pinId>
+    struct GpioPin
+    {
+        /// @brief This method initialize a gpio pin to be used for a given function.
+        ///
+        /// @param function The function for what the pin should be used.
+        STATIC_INLINE void init(GpioFunction function)
+        {
+            GpioHal::init<pinId>(function);
+        }
+
+        /// @brief This method sets the logic level of a gpio pin.
+        /// @attention This method only works when the pin is configured as output.
+        ///
+        /// @param level The new logic level.
+        STATIC_INLINE void setOut(const boolean_t level)
+        {
+            GpioHal::setOut<pinId>(level);
+        }
+
+        /// @brief This method sets the logic level of a gpio pin to high.
+        /// @attention This method only works when the pin is configured as output.
+        STATIC_INLINE void setOutHigh()
+        {
+            GpioHal::setOut<pinId>(TRUE);
+        }
+
+        /// @brief This method sets the logic level of a gpio pin to low.
+        /// @attention This method only works when the pin is configured as output.
+        STATIC_INLINE void setOutLow()
+        {
+            GpioHal::setOut<pinId>(FALSE);
+        }
+
+        /// @brief This method toggles the logic level of a gpio pin.
+        /// @attention This method only works when the pin is configured as output.
+        STATIC_INLINE void toggleOut()
+        {
+            GpioHal::toggleOut<pinId>();
+        }
+
+        /// @brief This method returns the actual logic level of a gpio pin.
+        ///
+        /// The level is read with a single load from the bit-band alias of the input register.
+        ///
+        /// @returns The measured logic level.
+        STATIC_INLINE boolean_t getIn()
+        {
+            return GpioHal::getIn<pinId>();
+        }
+
+    private:
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        GpioPin();
+    };
+
+/// This class is the static counterpart to GpioDummyPin. It can be used wherever a GpioPin
+/// type is expected. All methods are empty and compile to nothing.
+/// @ingroup Gpio
+struct GpioNoPin
+{
+    /// Does nothing.
+    STATIC_INLINE void init(GpioFunction function)
+    {
+    }
+
+    /// Does nothing.
+    STATIC_INLINE void setOut(const boolean_t level)
+    {
+    }
+
+    /// Does nothing.
+    STATIC_INLINE void setOutHigh()
+    {
+    }
+
+    /// Does nothing.
+    STATIC_INLINE void setOutLow()
+    {
+    }
+
+    /// Does nothing.
+    STATIC_INLINE void toggleOut()
+    {
+    }
+
+    /// Does nothing.
+    /// @returns Always false.
+    STATIC_INLINE boolean_t getIn()
+    {
+        return FALSE;
+    }
+
+private:
+    /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+    GpioNoPin();
+};
+
+/// This template class is a static access object to a complete gpio port.
+///
+/// @tparam portId The port identifier.
+/// @ingroup Gpio
+template<GpioPortId portId>
+    struct GpioPort
+    {
+        /// @brief This method writes the output levels of all pins of the port with a single store.
+        /// @attention This method only affects pins which are configured as output.
+        ///
+        /// @param value The new logic levels. Bit x is the level of pin x.
+        STATIC_INLINE void write(const uint32_t value)
+        {
+            GpioHal::writePort<portId>(value);
+        }
+
+        /// @brief This method returns the output levels of all pins of the port.
+        ///
+        /// @returns The output levels. Bit x is the level of pin x.
+        STATIC_INLINE uint32_t readOut()
+        {
+            return GpioHal::readPortOut<portId>();
+        }
+
+        /// @brief This method returns the input levels of all pins of the port with a single load.
+        ///
+        /// @returns The measured logic levels. Bit x is the level of pin x.
+        STATIC_INLINE uint32_t read()
+        {
+            return GpioHal::readPort<portId>();
+        }
+
+    private:
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        GpioPort();
+    };
+
+/// @brief This template class is a static access object to a group of pins on the same port.
+///
+/// All pins of the group are changed with one access to the port output register. See
+/// GpioHal::writePortMasked() for details on atomicity.
+///
+/// @tparam portId The port identifier.
+/// @tparam pinMask The pins of the group. Bit x selects pin x.
+/// @ingroup Gpio
+template<GpioPortId portId, uint32_t pinMask>
+    struct GpioPinGroup
+    {
+        static const GpioPortId port = portId; ///< The port of the group.
+        static const uint32_t mask = pinMask; ///< The pins of the group. Bit x selects pin x.
+        static const uint32_t shift = __builtin_ctz(pinMask); ///< Position of the lowest pin of the group.
+
+        /// @brief This method sets the output levels of all pins of the group.
+        ///
+        /// @param value The new logic levels. Bit x is the level of pin x. Bits of other pins are ignored.
+        STATIC_INLINE void write(const uint32_t value)
+        {
+            GpioHal::writePortMasked<portId, pinMask>(value);
+        }
+
+        /// @brief This method sets the output levels of the group as a parallel bus.
+        ///
+        /// @param value The new logic levels. Bit 0 is the level of the lowest pin of the group.
+        STATIC_INLINE void writeShifted(const uint32_t value)
+        {
+            GpioHal::writePortMasked<portId, pinMask>(value << shift);
+        }
+
+        /// @brief This method returns the input levels of all pins of the group.
+        ///
+        /// @returns The measured logic levels. Bit x is the level of pin x. Bits of other pins are 0.
+        STATIC_INLINE uint32_t read()
+        {
+            return GpioHal::readPort<portId>() & pinMask;
+        }
+
+        /// @brief This method returns the input levels of the group as a parallel bus.
+        ///
+        /// @returns The measured logic levels. Bit 0 is the level of the lowest pin of the group.
+        STATIC_INLINE uint32_t readShifted()
+        {
+            return (GpioHal::readPort<portId>() & pinMask) >> shift;
+        }
+
+        /// This method sets the output levels of all pins of the group to high.
+        STATIC_INLINE void set()
+        {
+            GpioHal::setPort<portId, pinMask>();
+        }
+
+        /// This method sets the output levels of all pins of the group to low.
+        STATIC_INLINE void clear()
+        {
+            GpioHal::clearPort<portId, pinMask>();
+        }
+
+        /// This method toggles the output levels of all pins of the group.
+        STATIC_INLINE void toggle()
+        {
+            GpioHal::togglePort<portId, pinMask>();
+        }
+
+    private:
+        static_assert(pinMask != 0u, "A pin group must contain at least one pin");
+
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        GpioPinGroup();
+    };
+
+/// @cond TEMPLATE_DOC
+template<GpioPinId ... pinIds>
+    struct GpioPinMask;
+
+template<GpioPinId pinId>
+    struct GpioPinMask<pinId>
+    {
+        static const GpioPortId port = GpioPinTraits<pinId>::port;
+        static const uint32_t mask = GpioPinTraits<pinId>::mask;
+    };
+
+template<GpioPinId first, GpioPinId second, GpioPinId ... rest>
+    struct GpioPinMask<first, second, rest...>
+    {
+        static const GpioPortId port = GpioPinTraits<first>::port;
+        static const uint32_t mask = GpioPinTraits<first>::mask | GpioPinMask<second, rest...>::mask;
+        static_assert(port == GpioPinMask<second, rest...>::port, "All pins of a group must be located on the same port");
+    };
+/// @endcond
+
+/// This template class builds a GpioPinGroup out of pin identifiers. All pins must be located on the
+/// same port. This is checked at compile time.
+///
+/// @tparam pinIds The pin identifiers.
+/// @ingroup Gpio
+template<GpioPinId ... pinIds>
+    struct GpioPins : public GpioPinGroup<GpioPinMask<pinIds...>::port, GpioPinMask<pinIds...>::mask>
+    {
+    };
+
+/// This template class is one entry of a GpioPinConfigTable.
+///
+/// @tparam pinId The pin identifier.
+/// @tparam function The function for what the pin should be used.
+/// @ingroup Gpio
+template<GpioPinId pinId, GpioFunction function>
+    struct GpioPinConfig
+    {
+        static_assert(GpioPinTraits<pinId>::analogInput != GPIO_HAL_UNKNOWN_ANALOG,
+                "The analog function of the pin is not handled. See GpioPinTraits.");
+
+        static constexpr GpioPortId port = GpioPinTraits<pinId>::port; ///< The port of the pin.
+        static constexpr uint32_t mask = GpioPinTraits<pinId>::mask; ///< The bit of the pin in the port registers.
+        static constexpr uint32_t adeMask = GpioPinTraits<pinId>::adeMask; ///< The analog input of the pin.
+        static constexpr bool output = GpioFunctionTraits<function>::output; ///< The pin is an output.
+        static constexpr bool high = GpioFunctionTraits<function>::high; ///< The initial output level is high.
+        static constexpr bool pullup = GpioFunctionTraits<function>::pullup; ///< The pull-up resistor is enabled.
+        static constexpr bool openDrain = GpioFunctionTraits<function>::openDrain; ///< The output is pseudo open drain.
+        static constexpr bool peripheral = GpioFunctionTraits<function>::peripheral; ///< The pin is used by a peripheral.
+    };
+
+/// @cond TEMPLATE_DOC
+template<GpioPortId portId, class ... Configs>
+    struct GpioPortConfig
+    {
+        static constexpr uint32_t pins = 0u;
+        static constexpr uint32_t outputs = 0u;
+        static constexpr uint32_t highs = 0u;
+        static constexpr uint32_t pullups = 0u;
+        static constexpr uint32_t openDrains = 0u;
+        static constexpr uint32_t peripherals = 0u;
+    };
+
+template<GpioPortId portId, class First, class ... Rest>
+    struct GpioPortConfig<portId, First, Rest...>
+    {
+        typedef GpioPortConfig<portId, Rest...> Next;
+        static constexpr uint32_t pin = (First::port == portId) ? First::mask : 0u;
+
+        static constexpr uint32_t pins = pin | Next::pins;
+        static constexpr uint32_t outputs = (First::output ? pin : 0u) | Next::outputs;
+        static constexpr uint32_t highs = (First::high ? pin : 0u) | Next::highs;
+        static constexpr uint32_t pullups = (First::pullup ? pin : 0u) | Next::pullups;
+        static constexpr uint32_t openDrains = (First::openDrain ? pin : 0u) | Next::openDrains;
+        static constexpr uint32_t peripherals = (First::peripheral ? pin : 0u) | Next::peripherals;
+    };
+
+template<class ... Configs>
+    struct GpioAnalogConfig
+    {
+        static constexpr uint32_t adeMask = 0u;
+    };
+
+template<class First, class ... Rest>
+    struct GpioAnalogConfig<First, Rest...>
+    {
+        static constexpr uint32_t adeMask = First::adeMask | GpioAnalogConfig<Rest...>::adeMask;
+    };
+/// @endcond
+
+/// @brief This template class is a pin configuration table which is evaluated at compile time.
+///
+/// The configurations of all pins on the same port are folded into one masked write per register.
+/// Compared to calling GpioPin::init() for each pin this saves execution time and code size.
+///
+/// Example:
+///
+///     typedef GpioPinConfigTable<
+///             GpioPinConfig<DEBUG_PIN1, GPIO_OUTPUT_LOW>,
+///             GpioPinConfig<LED_RED, GPIO_OUTPUT_LOW> > PinConfig;
+///
+///     PinConfig::apply();
+///
+/// @tparam Configs The GpioPinConfig entries of the table. Each pin must be listed only once.
+/// @ingroup Gpio
+template<class ... Configs>
+    struct GpioPinConfigTable
+    {
+        /// This method applies the configuration of all pins in the table.
+        STATIC_INLINE void apply()
+        {
+            applyPort<GPIO_PORT0>();
+            applyPort<GPIO_PORT1>();
+            applyPort<GPIO_PORT2>();
+            applyPort<GPIO_PORT3>();
+            applyPort<GPIO_PORT4>();
+            applyPort<GPIO_PORT5>();
+            applyPort<GPIO_PORT6>();
+            applyPort<GPIO_PORT7>();
+            applyPort<GPIO_PORT8>();
+            applyPort<GPIO_PORT9>();
+            applyPort<GPIO_PORTA>();
+            applyPort<GPIO_PORTB>();
+            applyPort<GPIO_PORTC>();
+            applyPort<GPIO_PORTD>();
+            applyPort<GPIO_PORTE>();
+            applyPort<GPIO_PORTF>();
+
+            GpioHal::disableAnalog<GpioAnalogConfig<Configs...>::adeMask>();
+        }
+
+    private:
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        GpioPinConfigTable();
+
+        /// Applies the configuration of all pins in the table which are located on a port.
+        template<GpioPortId portId>
+            STATIC_INLINE void applyPort()
+            {
+                typedef GpioPortConfig<portId, Configs...> Port;
+                GpioHal::initPort<portId, Port::pins, Port::outputs, Port::highs, Port::pullups, Port::openDrains,
+                        Port::peripherals>();
+            }
+
+    };
+
 /// Base interface to all GpioHardwarePin and GpioDummyPin classes.
 /// @ingroup Gpio
 struct IGpioPin
@@ -48,7 +414,6 @@ struct IGpioPin
     virtual void toggleOut() const = 0;
 
     /// @brief This method returns the actual logic level of a gpio pin.
-    /// @attention This method only works when the pin is configured as input.
     ///
     /// @returns The measured logic level.
     virtual boolean_t getIn() const = 0;
@@ -84,8 +449,8 @@ struct GpioDummyPin : public IGpioPin
     }
 };
 
-/// This template class is used to build access objects to the actual hardware. These access objects do all
-/// share the same base class GpioPin.
+/// This template class adapts the static GpioPin access object to the type erased IGpioPin
+/// interface. These access objects do all share the same base class IGpioPin.
 ///
 /// @tparam pinId The pin identifier.
 /// @ingroup Gpio
@@ -94,40 +459,43 @@ template<GpioPinId pinId>
     {
         INLINE void init(GpioFunction function)
         {
-            GpioHal::init<pinId>(function);
+            GpioPin<pinId>::init(function);
         }
 
         INLINE void setOut(const boolean_t level) const
         {
-            GpioHal::setOut<pinId>(level);
+            GpioPin<pinId>::setOut(level);
         }
 
         INLINE void setOutHigh() const
         {
-            GpioHal::setOut<pinId>(TRUE);
+            GpioPin<pinId>::setOutHigh();
         }
 
         INLINE void setOutLow() const
         {
-            GpioHal::setOut<pinId>(FALSE);
+            GpioPin<pinId>::setOutLow();
         }
 
         INLINE void toggleOut() const
         {
-            GpioHal::toggleOut<pinId>();
+            GpioPin<pinId>::toggleOut();
         }
 
         INLINE boolean_t getIn() const
         {
-            return GpioHal::getIn<pinId>();
+            return GpioPin<pinId>::getIn();
         }
     };
 
-/// This class administers all available GpioPin objects. The available
-/// GpioPin objects are listed in the enum GpioPinId.
+/// This class administers all available IGpioPin objects. The available
+/// IGpioPin objects are listed in the enum GpioPinId.
+///
+/// Use this class only when a pin must be selected at runtime. Otherwise
+/// use the static GpioPin access objects.
 struct GpioController
 {
-    /// Get a pointer to the requested GpioPin object.
+    /// Get a pointer to the requested IGpioPin object.
     ///
     /// @tparam pinId The pin identifier.
     template<GpioPinId pinId>
@@ -0,0 +1,51 @@
+/// @file
+/// @brief Definition of static methods to access the dwt cycle counter.
+///
+/// The cortex-m4 data watchpoint and trace unit (DWT) contains a 32 bit counter which is
+/// incremented with each cpu cycle. It is used for time measurements with cycle resolution.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+
+#ifndef __CYCLE_COUNTER_H__
+#define __CYCLE_COUNTER_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "utils.h"
+
+/// This class contains static methods to access the dwt cycle counter.
+struct CycleCounter
+{
+    /// @brief This method enables the cycle counter and resets it to 0.
+    ///
+    /// It is called once at startup by ISR_Reset().
+    STATIC_INLINE void enable()
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // enable the trace and debug blocks (DWT)
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    /// @brief This method returns the actual value of the cycle counter.
+    ///
+    /// The counter wraps around after 2^32 cycles. The difference of two values is correct
+    /// as long as it is calculated with unsigned 32 bit arithmetic.
+    ///
+    /// In the host simulation the counter does not run. The host clock in nanoseconds is returned instead.
+    ///
+    /// @returns The actual cycle count.
+    STATIC_INLINE uint32_t now()
+    {
+#ifdef HOST_SIMULATION
+        return HOST_getClock();
+#else
+        return DWT->CYCCNT;
+#endif
+    }
+
+private:
+    /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+    CycleCounter();
+};
+
+#endif
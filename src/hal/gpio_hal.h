@@ -37,23 +37,195 @@
 // -  When "0" is set, it outputs Low level.
 // -  When "1" is set, it outputs High level.
 // Note: If a pin is selected as GPIO input or input/output of peripheral functions, a setting value is invalid.
+//
+// PDIR
+// A register to read the input level of the pin. It reflects the pin level regardless of the pin function.
+//
+// PCR
+// A register to enable the pull-up resistor of the pin. It is only effective when the pin is a GPIO input.
+//
+// PZR
+// A register to set the pseudo open drain mode. When "1" is set, a high level in PDOR sets the output
+// to Hi-Z instead of driving high.
+//
+// Each register exists once per port. The register of port x is located at: register base + 4 * x.
+// The FM4 has no dedicated set/clear registers. Multiple bits of a port can only be changed at once
+// with a (read-modify-)write access to the complete PDOR word. A single bit is changed atomically
+// through its bit-band alias.
+
+/// Base address of the peripheral bit-band region
+#define GPIO_HAL_PERIPH_BASE        0x40000000u
+
+/// Base address of the peripheral bit-band alias region
+#define GPIO_HAL_PERIPH_ALIAS_BASE  0x42000000u
+
+/// Offset of the PFR registers to the gpio base address
+#define GPIO_HAL_PFR_OFFSET         0x000u
+
+/// Offset of the PCR registers to the gpio base address
+#define GPIO_HAL_PCR_OFFSET         0x100u
+
+/// Offset of the DDR registers to the gpio base address
+#define GPIO_HAL_DDR_OFFSET         0x200u
+
+/// Offset of the PDIR registers to the gpio base address
+#define GPIO_HAL_PDIR_OFFSET        0x300u
+
+/// Offset of the PDOR registers to the gpio base address
+#define GPIO_HAL_PDOR_OFFSET        0x400u
+
+/// Offset of the ADE register to the gpio base address
+#define GPIO_HAL_ADE_OFFSET         0x500u
 
-/// This enum lists all currently supported Pins.
+/// Offset of the PZR registers to the gpio base address
+#define GPIO_HAL_PZR_OFFSET         0x700u
+
+/// Mask containing all pins of a port. A port consists out of up to 16 pins.
+#define GPIO_HAL_PORT_MASK          0xFFFFu
+
+/// Analog input (see GpioPinTraits::analogInput) of a pin which has no analog function
+#define GPIO_HAL_NO_ANALOG          0xFEu
+
+/// Analog input (see GpioPinTraits::analogInput) of a pin whose analog function is not handled
+#define GPIO_HAL_UNKNOWN_ANALOG     0xFFu
+
+/// @brief This enum lists all pins of the MB9BF568R.
+///
+/// The value of a pin encodes its location: bits 7 - 4 are the port and bits 3 - 0 are the bit in the
+/// port registers. GpioPinTraits derives the register accesses from it. The list equals the
+/// bFM4_GPIO_PDORx_Py bits of the vendor header. The board specific names are aliases.
 /// @ingroup Gpio
 enum GpioPinId
 {
-    DEBUG_PIN1, DEBUG_PIN2, DEBUG_PIN3, DEBUG_PIN4, LED_RED, LED_GREEN, LED_BLUE
+    GPIO_P00 = 0x00, GPIO_P01 = 0x01, GPIO_P02 = 0x02, GPIO_P03 = 0x03,
+    GPIO_P04 = 0x04, GPIO_P05 = 0x05, GPIO_P06 = 0x06, GPIO_P07 = 0x07,
+    GPIO_P08 = 0x08, GPIO_P09 = 0x09, GPIO_P0A = 0x0A, GPIO_P0B = 0x0B,
+    GPIO_P0C = 0x0C, GPIO_P0D = 0x0D, GPIO_P0E = 0x0E,
+    GPIO_P10 = 0x10, GPIO_P11 = 0x11, GPIO_P12 = 0x12, GPIO_P13 = 0x13,
+    GPIO_P14 = 0x14, GPIO_P15 = 0x15, GPIO_P16 = 0x16, GPIO_P17 = 0x17,
+    GPIO_P18 = 0x18, GPIO_P19 = 0x19, GPIO_P1A = 0x1A, GPIO_P1B = 0x1B,
+    GPIO_P1C = 0x1C, GPIO_P1D = 0x1D, GPIO_P1E = 0x1E, GPIO_P1F = 0x1F,
+    GPIO_P20 = 0x20, GPIO_P21 = 0x21, GPIO_P22 = 0x22, GPIO_P23 = 0x23,
+    GPIO_P24 = 0x24, GPIO_P25 = 0x25, GPIO_P26 = 0x26, GPIO_P27 = 0x27,
+    GPIO_P30 = 0x30, GPIO_P31 = 0x31, GPIO_P32 = 0x32, GPIO_P33 = 0x33,
+    GPIO_P34 = 0x34, GPIO_P35 = 0x35, GPIO_P36 = 0x36, GPIO_P37 = 0x37,
+    GPIO_P38 = 0x38, GPIO_P39 = 0x39, GPIO_P3A = 0x3A, GPIO_P3B = 0x3B,
+    GPIO_P3C = 0x3C, GPIO_P3D = 0x3D, GPIO_P3E = 0x3E, GPIO_P3F = 0x3F,
+    GPIO_P40 = 0x40, GPIO_P41 = 0x41, GPIO_P42 = 0x42, GPIO_P43 = 0x43,
+    GPIO_P44 = 0x44, GPIO_P45 = 0x45, GPIO_P46 = 0x46, GPIO_P47 = 0x47,
+    GPIO_P48 = 0x48, GPIO_P49 = 0x49, GPIO_P4B = 0x4B, GPIO_P4C = 0x4C,
+    GPIO_P4D = 0x4D, GPIO_P4E = 0x4E,
+    GPIO_P50 = 0x50, GPIO_P51 = 0x51, GPIO_P52 = 0x52, GPIO_P53 = 0x53,
+    GPIO_P54 = 0x54, GPIO_P55 = 0x55, GPIO_P56 = 0x56, GPIO_P57 = 0x57,
+    GPIO_P58 = 0x58, GPIO_P59 = 0x59, GPIO_P5A = 0x5A, GPIO_P5B = 0x5B,
+    GPIO_P60 = 0x60, GPIO_P61 = 0x61, GPIO_P62 = 0x62, GPIO_P63 = 0x63,
+    GPIO_P64 = 0x64, GPIO_P65 = 0x65, GPIO_P66 = 0x66, GPIO_P67 = 0x67,
+    GPIO_P68 = 0x68,
+    GPIO_P70 = 0x70, GPIO_P71 = 0x71, GPIO_P72 = 0x72, GPIO_P73 = 0x73,
+    GPIO_P74 = 0x74,
+    GPIO_P80 = 0x80, GPIO_P81 = 0x81,
+    GPIO_PE0 = 0xE0, GPIO_PE2 = 0xE2, GPIO_PE3 = 0xE3,
+
+    DEBUG_PIN1 = GPIO_P1F, ///< Debug pin 1 (P1F)
+    DEBUG_PIN2 = GPIO_P1A, ///< Debug pin 2 (P1A)
+    DEBUG_PIN3 = GPIO_P19, ///< Debug pin 3 (P19)
+    DEBUG_PIN4 = GPIO_P25, ///< Debug pin 4 (P25)
+    LED_RED = GPIO_P27,    ///< Red led of the rgb led, low active (P27)
+    LED_GREEN = GPIO_P38,  ///< Green led of the rgb led, low active (P38)
+    LED_BLUE = GPIO_PE0    ///< Blue led of the rgb led, low active (PE0)
 };
 
 /// This enum lists all possible gpio functions.
 /// @ingroup Gpio
 enum GpioFunction
 {
-    GPIO_OUTPUT_LOW ///<  Set the gpio function to output with initial low level
+    GPIO_OUTPUT_LOW,        ///<  Set the gpio function to output with initial low level
+    GPIO_OUTPUT_HIGH,       ///<  Set the gpio function to output with initial high level
+    GPIO_OUTPUT_OPEN_DRAIN, ///<  Set the gpio function to pseudo open drain output. Initially the output is released (Hi-Z).
+    GPIO_INPUT,             ///<  Set the gpio function to input without pull-up resistor
+    GPIO_INPUT_PULLUP,      ///<  Set the gpio function to input with pull-up resistor
+    GPIO_PERIPHERAL         ///<  Pass the pin to a peripheral function. The peripheral is selected with the EPFR registers.
+};
+
+/// This enum lists all gpio ports. The value equals the port number.
+/// @ingroup Gpio
+enum GpioPortId
+{
+    GPIO_PORT0,
+    GPIO_PORT1,
+    GPIO_PORT2,
+    GPIO_PORT3,
+    GPIO_PORT4,
+    GPIO_PORT5,
+    GPIO_PORT6,
+    GPIO_PORT7,
+    GPIO_PORT8,
+    GPIO_PORT9,
+    GPIO_PORTA,
+    GPIO_PORTB,
+    GPIO_PORTC,
+    GPIO_PORTD,
+    GPIO_PORTE,
+    GPIO_PORTF
 };
 
-/// This class contains static template methods which perform the actual hardware accesses. For each pin identifier
-/// listed in GpioPinId all methods contained in this class must be specialized.
+/// @brief This template class describes where a pin is located.
+///
+/// The location is decoded from the value of the pin identifier at compile time.
+///
+/// The MB9BF568R has the analog inputs AN00 - AN23. After reset they are in analog mode, the ADE
+/// register switches them to digital use. AN00 - AN14 are located at P10 - P1E. P1F, P25, P27, P38
+/// and PE0 are driven as digital outputs by the board without an ADE setting, they are listed as
+/// pins without analog function. The pins of AN15 - AN23 are not handled: the analog function of all
+/// other pins is unknown and GpioHal::init() and GpioPinConfig reject them at compile time. Before such
+/// a pin is used, it must be added to analogInput with its ADE bit from the pin table of the data sheet
+/// or with GPIO_HAL_NO_ANALOG.
+///
+/// @tparam pinId The pin identifier.
+/// @ingroup Gpio
+template<GpioPinId pinId>
+    struct GpioPinTraits
+    {
+        /// The GpioPortId of the port the pin belongs to.
+        static const GpioPortId port = (GpioPortId) (pinId >> 4);
+
+        /// The bit of the pin in the port registers.
+        static const uint32_t mask = 1u << (pinId & 0xFu);
+
+        /// The analog input (ADE bit) of the pin, GPIO_HAL_NO_ANALOG or GPIO_HAL_UNKNOWN_ANALOG.
+        static const uint32_t analogInput =
+                (port == GPIO_PORT1 && (pinId & 0xFu) != 0xFu) ? (uint32_t) (pinId & 0xFu) :
+                (pinId == GPIO_P1F || pinId == GPIO_P25 || pinId == GPIO_P27 || pinId == GPIO_P38
+                        || pinId == GPIO_PE0) ? GPIO_HAL_NO_ANALOG : GPIO_HAL_UNKNOWN_ANALOG;
+
+        /// The bit of the analog input in the ADE register or 0 when the pin has no analog function.
+        static const uint32_t adeMask = (analogInput < 32u) ? 1u << (analogInput & 31u) : 0u;
+    };
+
+/// This template class describes the register settings of a gpio function. For each function listed in
+/// GpioFunction it must be specialized with the members:
+///
+/// * output - The pin is an output (DDR).
+/// * high - The initial output level is high (PDOR).
+/// * pullup - The pull-up resistor is enabled (PCR).
+/// * openDrain - The output is pseudo open drain (PZR).
+/// * peripheral - The pin is used by a peripheral function (PFR).
+///
+/// @tparam function The gpio function.
+/// @ingroup Gpio
+template<GpioFunction function>
+    struct GpioFunctionTraits;
+
+#ifdef HOST_SIMULATION
+/// Reference to a single register bit. On the host it is a proxy which changes the bit in the simulated register file.
+typedef HostBitBand GpioHalBit;
+#else
+/// Reference to a single register bit. On the target it is the bit-band alias of the bit.
+typedef volatile uint32_t& GpioHalBit;
+#endif
+
+/// This class contains static template methods which perform the actual hardware accesses. All methods
+/// use GpioPinTraits to locate the pin. Single bits are accessed through their bit-band alias.
 /// @ingroup Gpio
 struct GpioHal
 {
@@ -62,7 +234,64 @@ struct GpioHal
     /// @tparam pinId The pin identifier.
     /// @param function The function for what the pin should be used.
     template<GpioPinId pinId>
-        STATIC_INLINE void init(GpioFunction function);
+        STATIC_INLINE void init(GpioFunction function)
+        {
+            switch (function)
+            {
+                case GPIO_OUTPUT_LOW:
+                    init<pinId, GPIO_OUTPUT_LOW>();
+                    break;
+
+                case GPIO_OUTPUT_HIGH:
+                    init<pinId, GPIO_OUTPUT_HIGH>();
+                    break;
+
+                case GPIO_OUTPUT_OPEN_DRAIN:
+                    init<pinId, GPIO_OUTPUT_OPEN_DRAIN>();
+                    break;
+
+                case GPIO_INPUT:
+                    init<pinId, GPIO_INPUT>();
+                    break;
+
+                case GPIO_INPUT_PULLUP:
+                    init<pinId, GPIO_INPUT_PULLUP>();
+                    break;
+
+                case GPIO_PERIPHERAL:
+                    init<pinId, GPIO_PERIPHERAL>();
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+    /// @brief This template method initializes a gpio pin to be used for a function known at compile time.
+    ///
+    /// Each register is changed through its bit-band alias. The output level is written first, so no
+    /// glitch occurs when the pin becomes an output.
+    ///
+    /// @tparam pinId The pin identifier.
+    /// @tparam function The function for what the pin should be used.
+    template<GpioPinId pinId, GpioFunction function>
+        STATIC_INLINE void init()
+        {
+            typedef GpioPinTraits<pinId> Pin;
+            typedef GpioFunctionTraits<function> Function;
+            static_assert(Pin::analogInput != GPIO_HAL_UNKNOWN_ANALOG,
+                    "The analog function of the pin is not handled. See GpioPinTraits.");
+
+            portBit<GPIO_HAL_PDOR_OFFSET, Pin::port, Pin::mask>() = Function::high;
+            portBit<GPIO_HAL_PZR_OFFSET, Pin::port, Pin::mask>() = Function::openDrain;
+            portBit<GPIO_HAL_PCR_OFFSET, Pin::port, Pin::mask>() = Function::pullup;
+            portBit<GPIO_HAL_DDR_OFFSET, Pin::port, Pin::mask>() = Function::output;
+            portBit<GPIO_HAL_PFR_OFFSET, Pin::port, Pin::mask>() = Function::peripheral;
+            if (Pin::adeMask != 0u)
+            {
+                bitBand<FM4_GPIO_BASE + GPIO_HAL_ADE_OFFSET, Pin::adeMask>() = 0u; // disable adc
+            }
+        }
 
     /// @brief This template method sets the logic level of a gpio pin.
     /// @attention This method only works when the pin is configured as output.
@@ -70,301 +299,313 @@ struct GpioHal
     /// @tparam pinId The pin identifier.
     /// @param level The new logic level.
     template<GpioPinId pinId>
-        STATIC_INLINE void setOut(const boolean_t level);
+        STATIC_INLINE void setOut(const boolean_t level)
+        {
+            typedef GpioPinTraits<pinId> Pin;
+            pdorBit<Pin::port, Pin::mask>() = level;
+        }
 
     /// @brief This template method toggles the logic level of a gpio pin.
     /// @attention This method only works when the pin is configured as output.
     ///
     /// @tparam pinId The pin identifier.
     template<GpioPinId pinId>
-        STATIC_INLINE void toggleOut();
+        STATIC_INLINE void toggleOut()
+        {
+            typedef GpioPinTraits<pinId> Pin;
+            pdorBit<Pin::port, Pin::mask>() ^= 1u;
+        }
 
     /// @brief This template method returns the actual logic level of a gpio pin.
-    /// @attention This method only works when the pin is configured as input.
+    ///
+    /// The level is read with a single load from the bit-band alias of the PDIR register. It
+    /// reflects the pin level regardless of the pin function.
     ///
     /// @tparam pinId The pin identifier.
     /// @returns The measured logic level.
     template<GpioPinId pinId>
-        STATIC_INLINE boolean_t getIn();
-
-private:
-    /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
-    GpioHal();
-
-};
-
-/// @cond TEMPLATE_DOC
-
-// *********************************************************************
-// DebugPin1 hardware access
-// *********************************************************************
-
-template<>
-    INLINE void GpioHal::setOut<DEBUG_PIN1>(const boolean_t level)
-    {
-        bFM4_GPIO_PDOR1_PF = level;
-    }
-
-template<>
-    INLINE void GpioHal::toggleOut<DEBUG_PIN1>()
-    {
-        bFM4_GPIO_PDOR1_PF ^= 0x1u;
-    }
-
-template<>
-    INLINE boolean_t GpioHal::getIn<DEBUG_PIN1>()
-    {
-        // not implemented
-        return false;
-    }
+        STATIC_INLINE boolean_t getIn()
+        {
+            typedef GpioPinTraits<pinId> Pin;
+            return portBit<GPIO_HAL_PDIR_OFFSET, Pin::port, Pin::mask>();
+        }
 
-template<>
-    INLINE void GpioHal::init<DEBUG_PIN1>(GpioFunction function)
-    {
-        switch (function)
+    /// @brief This template method returns the input levels of all pins of a port with a single load.
+    ///
+    /// @tparam portId The port identifier.
+    /// @returns The measured logic levels. Bit x is the level of pin x.
+    template<GpioPortId portId>
+        STATIC_INLINE uint32_t readPort()
         {
-            case GPIO_OUTPUT_LOW:
-                setOut<DEBUG_PIN1>(false);
-                bFM4_GPIO_DDR1_PF = 1;
-                bFM4_GPIO_PFR1_PF = 0;
-                break;
-
-            default:
-                break;
+            return portReg<GPIO_HAL_PDIR_OFFSET, portId>();
         }
-    }
-// *********************************************************************
-// DebugPin2 hardware access
-// *********************************************************************
 
-template<>
-    INLINE void GpioHal::setOut<DEBUG_PIN2>(const boolean_t level)
-    {
-        bFM4_GPIO_PDOR1_PA = level;
-    }
+    /// @brief This template method writes all output levels of a port with a single store.
+    /// @attention This method only affects pins which are configured as output.
+    ///
+    /// @tparam portId The port identifier.
+    /// @param value The new logic levels. Bit x is the level of pin x.
+    template<GpioPortId portId>
+        STATIC_INLINE void writePort(const uint32_t value)
+        {
+            pdor<portId>() = value;
+        }
 
-template<>
-    INLINE void GpioHal::toggleOut<DEBUG_PIN2>()
-    {
-        bFM4_GPIO_PDOR1_PA ^= 0x1u;
-    }
+    /// @brief This template method returns the output levels of a port.
+    ///
+    /// @tparam portId The port identifier.
+    /// @returns The output levels. Bit x is the level of pin x.
+    template<GpioPortId portId>
+        STATIC_INLINE uint32_t readPortOut()
+        {
+            return pdor<portId>();
+        }
 
-template<>
-    INLINE boolean_t GpioHal::getIn<DEBUG_PIN2>()
-    {
-        // not implemented
-        return false;
-    }
+    /// @brief This template method sets the output levels of the masked pins to the given value.
+    ///
+    /// If the mask covers the complete port the levels are written with a single store. If the mask
+    /// contains a single pin its bit-band alias is used. Otherwise a read-modify-write access to the
+    /// PDOR register is necessary.
+    /// @attention The read-modify-write access is not atomic. It must not be interrupted by an isr
+    /// which changes pins of the same port.
+    ///
+    /// @tparam portId The port identifier.
+    /// @tparam mask The pins to change. Bit x selects pin x.
+    /// @param value The new logic levels. Bits not contained in mask are ignored.
+    template<GpioPortId portId, uint32_t mask>
+        STATIC_INLINE void writePortMasked(const uint32_t value)
+        {
+            if ((mask & GPIO_HAL_PORT_MASK) == GPIO_HAL_PORT_MASK)
+            {
+                pdor<portId>() = value;
+            }
+            else if (isSingleBit(mask))
+            {
+                pdorBit<portId, mask>() = (value & mask) ? 1u : 0u;
+            }
+            else
+            {
+                pdor<portId>() = (pdor<portId>() & ~mask) | (value & mask);
+            }
+        }
 
-template<>
-    INLINE void GpioHal::init<DEBUG_PIN2>(GpioFunction function)
-    {
-        switch (function)
+    /// @brief This template method sets the output levels of the masked pins to high.
+    /// @attention See writePortMasked() for atomicity.
+    ///
+    /// @tparam portId The port identifier.
+    /// @tparam mask The pins to set. Bit x selects pin x.
+    template<GpioPortId portId, uint32_t mask>
+        STATIC_INLINE void setPort()
         {
-            case GPIO_OUTPUT_LOW:
-                setOut<DEBUG_PIN2>(false);
-                bFM4_GPIO_DDR1_PA = 1;
-                bFM4_GPIO_PFR1_PA = 0;
-                bFM4_GPIO_ADE_AN10 = 0; // disable adc
-                break;
-
-            default:
-                break;
+            if (isSingleBit(mask))
+            {
+                pdorBit<portId, mask>() = 1u;
+            }
+            else
+            {
+                pdor<portId>() |= mask;
+            }
         }
-    }
-// *********************************************************************
-// DebugPin3 hardware access
-// *********************************************************************
 
-template<>
-    INLINE void GpioHal::setOut<DEBUG_PIN3>(const boolean_t level)
-    {
-        bFM4_GPIO_PDOR1_P9 = level;
-    }
+    /// @brief This template method sets the output levels of the masked pins to low.
+    /// @attention See writePortMasked() for atomicity.
+    ///
+    /// @tparam portId The port identifier.
+    /// @tparam mask The pins to clear. Bit x selects pin x.
+    template<GpioPortId portId, uint32_t mask>
+        STATIC_INLINE void clearPort()
+        {
+            if (isSingleBit(mask))
+            {
+                pdorBit<portId, mask>() = 0u;
+            }
+            else
+            {
+                pdor<portId>() &= ~mask;
+            }
+        }
 
-template<>
-    INLINE void GpioHal::toggleOut<DEBUG_PIN3>()
-    {
-        bFM4_GPIO_PDOR1_P9 ^= 0x1u;
-    }
+    /// @brief This template method toggles the output levels of the masked pins.
+    /// @attention See writePortMasked() for atomicity.
+    ///
+    /// @tparam portId The port identifier.
+    /// @tparam mask The pins to toggle. Bit x selects pin x.
+    template<GpioPortId portId, uint32_t mask>
+        STATIC_INLINE void togglePort()
+        {
+            if (isSingleBit(mask))
+            {
+                pdorBit<portId, mask>() ^= 1u;
+            }
+            else
+            {
+                pdor<portId>() ^= mask;
+            }
+        }
 
-template<>
-    INLINE boolean_t GpioHal::getIn<DEBUG_PIN3>()
-    {
-        // not implemented
-        return false;
-    }
+    /// @brief This template method configures several pins of a port at once.
+    ///
+    /// Each register is changed with a single masked write. The output levels are written first, so
+    /// no glitch occurs when a pin becomes an output.
+    /// @attention The masked writes are not atomic. This method is intended to be called at startup.
+    ///
+    /// @tparam portId The port identifier.
+    /// @tparam pins The pins to configure. Bit x selects pin x.
+    /// @tparam outputs The pins which are configured as outputs.
+    /// @tparam highs The pins whose output level is initialized with high.
+    /// @tparam pullups The pins whose pull-up resistor is enabled.
+    /// @tparam openDrains The pins which are configured as pseudo open drain outputs.
+    /// @tparam peripherals The pins which are used by peripheral functions.
+    template<GpioPortId portId, uint32_t pins, uint32_t outputs, uint32_t highs, uint32_t pullups,
+            uint32_t openDrains, uint32_t peripherals>
+        STATIC_INLINE void initPort()
+        {
+            if (pins != 0u)
+            {
+                writeMasked(portReg<GPIO_HAL_PDOR_OFFSET, portId>(), pins, highs);
+                writeMasked(portReg<GPIO_HAL_PZR_OFFSET, portId>(), pins, openDrains);
+                writeMasked(portReg<GPIO_HAL_PCR_OFFSET, portId>(), pins, pullups);
+                writeMasked(portReg<GPIO_HAL_DDR_OFFSET, portId>(), pins, outputs);
+                writeMasked(portReg<GPIO_HAL_PFR_OFFSET, portId>(), pins, peripherals);
+            }
+        }
 
-template<>
-    INLINE void GpioHal::init<DEBUG_PIN3>(GpioFunction function)
-    {
-        switch (function)
+    /// @brief This template method switches several pins from analog input to digital input/output.
+    ///
+    /// @tparam adeMask The analog inputs to disable. See GpioPinTraits::adeMask.
+    template<uint32_t adeMask>
+        STATIC_INLINE void disableAnalog()
         {
-            case GPIO_OUTPUT_LOW:
-                setOut<DEBUG_PIN3>(false);
-                bFM4_GPIO_DDR1_P9 = 1;
-                bFM4_GPIO_PFR1_P9 = 0;
-                bFM4_GPIO_ADE_AN09 = 0; // disable adc
-                break;
-
-            default:
-                break;
+            if (adeMask != 0u)
+            {
+                FM4_GPIO_ADE &= ~adeMask;
+            }
         }
-    }
 
-// *********************************************************************
-// DebugPin4 hardware access
-// *********************************************************************
+private:
+    /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+    GpioHal();
 
-template<>
-    INLINE void GpioHal::setOut<DEBUG_PIN4>(const boolean_t level)
+    /// Sets the masked bits of a register to value.
+    STATIC_INLINE void writeMasked(volatile uint32_t& reg, const uint32_t mask, const uint32_t value)
     {
-        bFM4_GPIO_PDOR2_P5 = level;
+        reg = (reg & ~mask) | (value & mask);
     }
 
-template<>
-    INLINE void GpioHal::toggleOut<DEBUG_PIN4>()
-    {
-        bFM4_GPIO_PDOR2_P5 ^= 0x1u;
-    }
+    /// Returns the register of a port which is located at the given offset to the gpio base address.
+    template<uint32_t offset, GpioPortId portId>
+        STATIC_INLINE volatile uint32_t& portReg()
+        {
+            return *((volatile uint32_t*) (FM4_GPIO_BASE + offset + 4u * portId));
+        }
 
-template<>
-    INLINE boolean_t GpioHal::getIn<DEBUG_PIN4>()
+    /// Returns true when exactly one bit of value is set.
+    STATIC_INLINE bool isSingleBit(const uint32_t value)
     {
-        // not implemented
-        return false;
+        return (value != 0u) && ((value & (value - 1u)) == 0u);
     }
 
-template<>
-    INLINE void GpioHal::init<DEBUG_PIN4>(GpioFunction function)
-    {
-        switch (function)
+    /// Returns the PDOR register of a port.
+    template<GpioPortId portId>
+        STATIC_INLINE volatile uint32_t& pdor()
         {
-            case GPIO_OUTPUT_LOW:
-                setOut<DEBUG_PIN4>(false);
-                bFM4_GPIO_DDR2_P5 = 1;
-                bFM4_GPIO_PFR2_P5 = 0;
-                break;
-
-            default:
-                break;
+            return portReg<GPIO_HAL_PDOR_OFFSET, portId>();
         }
-    }
-
-// *********************************************************************
-// LED_RED hardware access
-// *********************************************************************
-
-template<>
-    INLINE void GpioHal::setOut<LED_RED>(const boolean_t level)
-    {
-        bFM4_GPIO_PDOR2_P7 = level;
-    }
 
-template<>
-    INLINE void GpioHal::toggleOut<LED_RED>()
-    {
-        bFM4_GPIO_PDOR2_P7 ^= 0x1u;
-    }
+    /// Returns the bit-band alias of the single PDOR bit selected by mask.
+    template<GpioPortId portId, uint32_t mask>
+        STATIC_INLINE GpioHalBit pdorBit()
+        {
+            return portBit<GPIO_HAL_PDOR_OFFSET, portId, mask>();
+        }
 
-template<>
-    INLINE boolean_t GpioHal::getIn<LED_RED>()
-    {
-        // not implemented
-        return false;
-    }
+    /// Returns the bit-band alias of the single bit selected by mask in the register of a port which is
+    /// located at the given offset to the gpio base address.
+    template<uint32_t offset, GpioPortId portId, uint32_t mask>
+        STATIC_INLINE GpioHalBit portBit()
+        {
+            return bitBand<FM4_GPIO_BASE + offset + 4u * portId, mask>();
+        }
 
-template<>
-    INLINE void GpioHal::init<LED_RED>(GpioFunction function)
-    {
-        switch (function)
+    /// Returns the bit-band alias of the single bit selected by mask in the peripheral register at address.
+    template<uint32_t address, uint32_t mask>
+        STATIC_INLINE GpioHalBit bitBand()
         {
-            case GPIO_OUTPUT_LOW:
-                setOut<LED_RED>(false);
-                bFM4_GPIO_DDR2_P7 = 1;
-                bFM4_GPIO_PFR2_P7 = 0;
-                break;
-
-            default:
-                break;
+#ifdef HOST_SIMULATION
+            return HostBitBand(*((volatile uint32_t*) (uintptr_t) address), mask);
+#else
+            return *((volatile uint32_t*) (GPIO_HAL_PERIPH_ALIAS_BASE + (address - GPIO_HAL_PERIPH_BASE) * 32u
+                    + 4u * __builtin_ctz(mask)));
+#endif
         }
-    }
+};
+
+/// @cond TEMPLATE_DOC
 
 // *********************************************************************
-// LED_GREEN hardware access
+// Function register settings
 // *********************************************************************
 
 template<>
-    INLINE void GpioHal::setOut<LED_GREEN>(const boolean_t level)
+    struct GpioFunctionTraits<GPIO_OUTPUT_LOW>
     {
-        bFM4_GPIO_PDOR3_P8 = level;
-    }
+        static const bool output = true;
+        static const bool high = false;
+        static const bool pullup = false;
+        static const bool openDrain = false;
+        static const bool peripheral = false;
+    };
 
 template<>
-    INLINE void GpioHal::toggleOut<LED_GREEN>()
+    struct GpioFunctionTraits<GPIO_OUTPUT_HIGH>
     {
-        bFM4_GPIO_PDOR3_P8 ^= 0x1u;
-    }
+        static const bool output = true;
+        static const bool high = true;
+        static const bool pullup = false;
+        static const bool openDrain = false;
+        static const bool peripheral = false;
+    };
 
 template<>
-    INLINE boolean_t GpioHal::getIn<LED_GREEN>()
+    struct GpioFunctionTraits<GPIO_OUTPUT_OPEN_DRAIN>
     {
-        // not implemented
-        return false;
-    }
+        static const bool output = true;
+        static const bool high = true;
+        static const bool pullup = false;
+        static const bool openDrain = true;
+        static const bool peripheral = false;
+    };
 
 template<>
-    INLINE void GpioHal::init<LED_GREEN>(GpioFunction function)
+    struct GpioFunctionTraits<GPIO_INPUT>
     {
-        switch (function)
-        {
-            case GPIO_OUTPUT_LOW:
-                setOut<LED_GREEN>(false);
-                bFM4_GPIO_DDR3_P8 = 1;
-                bFM4_GPIO_PFR3_P8 = 0;
-                break;
-
-            default:
-                break;
-        }
-    }
-// *********************************************************************
-// LED_BLUE hardware access
-// *********************************************************************
+        static const bool output = false;
+        static const bool high = false;
+        static const bool pullup = false;
+        static const bool openDrain = false;
+        static const bool peripheral = false;
+    };
 
 template<>
-    INLINE void GpioHal::setOut<LED_BLUE>(const boolean_t level)
+    struct GpioFunctionTraits<GPIO_INPUT_PULLUP>
     {
-        bFM4_GPIO_PDORE_P0 = level;
-    }
+        static const bool output = false;
+        static const bool high = false;
+        static const bool pullup = true;
+        static const bool openDrain = false;
+        static const bool peripheral = false;
+    };
 
 template<>
-    INLINE void GpioHal::toggleOut<LED_BLUE>()
+    struct GpioFunctionTraits<GPIO_PERIPHERAL>
     {
-        bFM4_GPIO_PDORE_P0 ^= 0x1u;
-    }
-
-template<>
-    INLINE boolean_t GpioHal::getIn<LED_BLUE>()
-    {
-        // not implemented
-        return false;
-    }
+        static const bool output = false;
+        static const bool high = false;
+        static const bool pullup = false;
+        static const bool openDrain = false;
+        static const bool peripheral = true;
+    };
 
-template<>
-    INLINE void GpioHal::init<LED_BLUE>(GpioFunction function)
-    {
-        switch (function)
-        {
-            case GPIO_OUTPUT_LOW:
-                setOut<LED_BLUE>(false);
-                bFM4_GPIO_DDRE_P0 = 1;
-                bFM4_GPIO_PFRE_P0 = 0;
-                break;
-
-            default:
-                break;
-        }
-    }
 /// @endcond
+
 #endif
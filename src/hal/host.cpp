@@ -0,0 +1,77 @@
+/// @file
+///
+/// @brief This file contains the implementation of the host simulation layer.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "mcu.h"
+#include "defer.h"
+#include "kernel.h"
+#include "host.h"
+
+uint32_t HOST_primask;
+uint32_t HOST_basepri;
+uint32_t HOST_ipsr;
+uint32_t HOST_sleepCount;
+uint32_t HOST_exclusiveMonitor;
+void (*HOST_sleepHook)(void);
+uint32_t (*HOST_preemptionHook)(void);
+
+/// @brief Maps anonymous memory to a fixed address range.
+///
+/// An existing mapping at the address is never replaced. The function aborts when the range is in use.
+///
+/// @param base The start address.
+/// @param size The size in bytes.
+static void mapRegion(const uintptr_t base, const size_t size)
+{
+    void* region = mmap((void*) base, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (region != (void*) base)
+    {
+        fprintf(stderr, "HOST_init: cannot map the register file at 0x%08lx\n", (unsigned long) base);
+        abort();
+    }
+}
+
+void HOST_init(void)
+{
+    static bool mapped = false;
+
+    if (!mapped)
+    {
+        mapRegion(HOST_PERIPH_BASE, HOST_PERIPH_SIZE);
+        mapRegion(HOST_PPB_BASE, HOST_PPB_SIZE);
+        mapped = true;
+    }
+
+    memset((void*) (uintptr_t) HOST_PERIPH_BASE, 0, HOST_PERIPH_SIZE);
+    memset((void*) (uintptr_t) HOST_PPB_BASE, 0, HOST_PPB_SIZE);
+    HOST_primask = 0u;
+    HOST_basepri = 0u;
+    HOST_ipsr = 0u;
+    HOST_sleepCount = 0u;
+    HOST_exclusiveMonitor = 0u;
+    HOST_preemptionHook = NULL;
+    HOST_sleepHook = NULL;
+}
+
+void ISR_PendSV(void)
+{
+    DEFER_drain();
+    KERNEL_current = KERNEL_next;
+}
+
+uint32_t HOST_getClock(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t) ((uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec);
+}
@@ -0,0 +1,277 @@
+/// @file
+///
+/// @brief This file contains the host simulation layer.
+///
+/// When the macro HOST_SIMULATION is defined the firmware modules are compiled with the host
+/// compiler (see the target host in the Makefile). The hardware is replaced as follows:
+///
+/// * Register file - HOST_init() maps anonymous memory to the fixed addresses of the peripheral
+///   region (0x40000000) and the private peripheral bus (0xE0000000). The FM4_* and cmsis register
+///   macros (SysTick, NVIC, DWT ...) can be used unchanged. The registers behave like plain memory.
+///   A test writes the input registers (e.g. PDIR, EIRR) and checks the output registers (e.g. PDOR).
+/// * Bit-band alias - The alias region is not mapped. GpioHal accesses single bits through a
+///   HostBitBand proxy instead, which changes the bit in the register file. The bFM4_* bit macros of
+///   the vendor header must not be used by modules which are compiled for the host.
+/// * Cpu intrinsics - The cmsis intrinsics which contain arm instructions are replaced by the
+///   functions below. Interrupts are simulated by calling the interrupt service routines directly.
+///   A test sets HOST_ipsr while it runs a routine.
+/// * Sleep - wfi and wfe return at once. A test installs HOST_sleepHook to simulate the time which
+///   passes while the core sleeps, e.g. the systick counter and the irq which wakes the core up.
+/// * Context switch - ISR_PendSV() of kernel_switch.s is replaced by a function which executes the
+///   deferred work and makes KERNEL_next the running thread. The stacks are not switched. A test
+///   calls it where the target would take PendSV and continues as the next thread.
+///
+/// * Preemption - Lock free code can be tested against interrupt service routines which preempt it
+///   at any exclusive access or memory barrier. A test installs HOST_preemptionHook, which decides at
+///   each of these points whether it runs a routine. A simulated preemption clears the exclusive
+///   monitor like the exception return on the target, so a pending strex fails.
+///
+/// @attention The host build is single threaded. Without HOST_preemptionHook the exclusive access
+/// intrinsics always succeed.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include <stdint.h>
+
+/// @brief This module contains the host simulation layer.
+///
+/// @defgroup Host Host Simulation
+
+/// Start address of the simulated peripheral region.
+/// @ingroup Host
+#define HOST_PERIPH_BASE    0x40000000u
+
+/// Size of the simulated peripheral region. It contains all FM4 peripherals.
+/// @ingroup Host
+#define HOST_PERIPH_SIZE    0x00100000u
+
+/// Start address of the simulated private peripheral bus (SysTick, NVIC, SCB, DWT ...).
+/// @ingroup Host
+#define HOST_PPB_BASE       0xE0000000u
+
+/// Size of the simulated private peripheral bus.
+/// @ingroup Host
+#define HOST_PPB_SIZE       0x00100000u
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief This function maps the simulated register file and clears all registers.
+///
+/// It replaces ISR_Reset() and must be called before any register is accessed. It can be called
+/// again to reset all registers, e.g. before each test.
+/// @ingroup Host
+void HOST_init(void);
+
+/// Simulated PRIMASK register. It is changed by __disable_irq() and __enable_irq().
+/// @ingroup Host
+extern uint32_t HOST_primask;
+
+/// Simulated BASEPRI register.
+/// @ingroup Host
+extern uint32_t HOST_basepri;
+
+/// Simulated IPSR register. It is 0 in thread mode, otherwise the number of the active exception.
+/// @ingroup Host
+extern uint32_t HOST_ipsr;
+
+/// Counts the executed wfi and wfe instructions.
+/// @ingroup Host
+extern uint32_t HOST_sleepCount;
+
+/// Simulated local exclusive monitor. It is set by ldrex and cleared by strex, clrex and each simulated preemption.
+/// @ingroup Host
+extern uint32_t HOST_exclusiveMonitor;
+
+/// @brief Simulated sleep. It is called at each wfi and wfe.
+///
+/// The function may advance the simulated peripherals and pend the irq which wakes the core up. It
+/// is NULL after HOST_init().
+/// @ingroup Host
+extern void (*HOST_sleepHook)(void);
+
+/// @brief Simulated preemption. It is called before each exclusive access, after each successful strex and at each memory barrier.
+///
+/// The function may run interrupt service routines, which preempt the code at that point. It is NULL
+/// after HOST_init().
+///
+/// @returns Not 0 when an interrupt service routine was run.
+/// @ingroup Host
+extern uint32_t (*HOST_preemptionHook)(void);
+
+/// @brief Simulated context switch. It replaces the PendSV routine of the kernel (kernel_switch.s).
+///
+/// It executes the deferred work (see defer.h) and makes KERNEL_next the running thread.
+/// @ingroup Host
+void ISR_PendSV(void);
+
+/// @brief This function returns the monotonic clock of the host. It replaces the dwt cycle counter.
+///
+/// @returns The clock in nanoseconds. It wraps around like the cycle counter.
+/// @ingroup Host
+uint32_t HOST_getClock(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/// @cond HOST_DOC
+
+static inline uint32_t HOST_clz(const uint32_t value)
+{
+    return (value == 0u) ? 32u : (uint32_t) __builtin_clz(value);
+}
+
+static inline uint32_t HOST_rbit(const uint32_t value)
+{
+    uint32_t result = 0u;
+    for (uint32_t bit = 0u; bit < 32u; bit++)
+    {
+        result |= ((value >> bit) & 1u) << (31u - bit);
+    }
+    return result;
+}
+
+static inline void HOST_preempt(void)
+{
+    if (HOST_preemptionHook != 0 && HOST_preemptionHook() != 0u)
+    {
+        HOST_exclusiveMonitor = 0u; // the exception return clears the monitor
+    }
+}
+
+static inline uint32_t HOST_ldrexw(volatile uint32_t* address)
+{
+    HOST_preempt();
+    const uint32_t value = *address;
+    HOST_exclusiveMonitor = 1u;
+    return value;
+}
+
+static inline uint32_t HOST_strexw(const uint32_t value, volatile uint32_t* address)
+{
+    HOST_preempt();
+    if (HOST_exclusiveMonitor == 0u)
+    {
+        return 1u;
+    }
+    HOST_exclusiveMonitor = 0u;
+    *address = value;
+    HOST_preempt();
+    return 0u;
+}
+
+static inline void HOST_barrier(void)
+{
+    __sync_synchronize();
+    HOST_preempt();
+}
+
+static inline void HOST_sleep(void)
+{
+    HOST_sleepCount++;
+    if (HOST_sleepHook != 0)
+    {
+        HOST_sleepHook();
+    }
+}
+
+static inline void HOST_setBasepriMax(const uint32_t value)
+{
+    if (value != 0u && (HOST_basepri == 0u || value < HOST_basepri))
+    {
+        HOST_basepri = value;
+    }
+}
+
+#undef __CLZ
+#define __CLZ(value)                HOST_clz(value)
+#undef __RBIT
+#define __RBIT(value)               HOST_rbit(value)
+#undef __LDREXW
+#define __LDREXW(address)           HOST_ldrexw(address)
+#undef __STREXW
+#define __STREXW(value, address)    HOST_strexw(value, address)
+#undef __CLREX
+#define __CLREX()                   ((void) (HOST_exclusiveMonitor = 0u))
+#undef __DMB
+#define __DMB()                     HOST_barrier()
+#undef __DSB
+#define __DSB()                     __sync_synchronize()
+#undef __ISB
+#define __ISB()                     __sync_synchronize()
+#undef __WFI
+#define __WFI()                     HOST_sleep()
+#undef __WFE
+#define __WFE()                     HOST_sleep()
+#undef __SEV
+#define __SEV()                     ((void) 0)
+#undef __disable_irq
+#define __disable_irq()             ((void) (HOST_primask = 1u))
+#undef __enable_irq
+#define __enable_irq()              ((void) (HOST_primask = 0u))
+#undef __get_PRIMASK
+#define __get_PRIMASK()             (HOST_primask)
+#undef __set_PRIMASK
+#define __set_PRIMASK(value)        ((void) (HOST_primask = (value)))
+#undef __get_BASEPRI
+#define __get_BASEPRI()             (HOST_basepri)
+#undef __set_BASEPRI
+#define __set_BASEPRI(value)        ((void) (HOST_basepri = (value)))
+#undef __set_BASEPRI_MAX
+#define __set_BASEPRI_MAX(value)    HOST_setBasepriMax(value)
+#undef __get_IPSR
+#define __get_IPSR()                (HOST_ipsr)
+
+#ifdef __cplusplus
+
+/// This class is a reference to a single register bit. It replaces the bit-band alias on the host.
+struct HostBitBand
+{
+    /// Constructor
+    HostBitBand(volatile uint32_t& word, const uint32_t mask) :
+            word(word), mask(mask)
+    {
+    }
+
+    /// Returns the bit (0 or 1).
+    operator uint32_t() const
+    {
+        return ((word & mask) != 0u) ? 1u : 0u;
+    }
+
+    /// Writes bit 0 of value into the bit.
+    const HostBitBand& operator=(const uint32_t value) const
+    {
+        if ((value & 1u) != 0u)
+        {
+            word |= mask;
+        }
+        else
+        {
+            word &= ~mask;
+        }
+        return *this;
+    }
+
+    /// Toggles the bit when bit 0 of value is set.
+    const HostBitBand& operator^=(const uint32_t value) const
+    {
+        return *this = *this ^ value;
+    }
+
+    volatile uint32_t& word; ///< The register which contains the bit.
+    const uint32_t mask; ///< The bit in the register.
+};
+
+#endif
+
+/// @endcond
+
+#endif
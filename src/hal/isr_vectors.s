@@ -57,9 +57,46 @@ _isr_vector_m:
 	.long hang                     // 013 - PendSV
 	.long ISR_Systick		       // 014 - SysTick
 
-	// 015 - 143
-	.rept 128                      // Currently no fm4 irq is enabled. Fill the vector table with branches to hang
-	.long hang                     // xxx - IRQx_Handler
+	// 015 - 143 - FM4 irqs. All irqs without interrupt service routine branch to hang.
+	.rept 11
+	.long hang                     // 000 - 010 - IRQx_Handler
+	.endr
+	.long ISR_Exint0               // 011 - EXINT0
+	.long ISR_Exint1               // 012 - EXINT1
+	.long ISR_Exint2               // 013 - EXINT2
+	.long ISR_Exint3               // 014 - EXINT3
+	.long ISR_Exint4               // 015 - EXINT4
+	.long ISR_Exint5               // 016 - EXINT5
+	.long ISR_Exint6               // 017 - EXINT6
+	.long ISR_Exint7               // 018 - EXINT7
+	.rept 21
+	.long hang                     // 019 - 039 - IRQx_Handler
+	.endr
+	.long ISR_BaseTimer1           // 040 - BT1
+	.rept 10
+	.long hang                     // 041 - 050 - IRQx_Handler
+	.endr
+	.long ISR_Exint8               // 051 - EXINT8
+	.long ISR_Exint9               // 052 - EXINT9
+	.long ISR_Exint10              // 053 - EXINT10
+	.long ISR_Exint11              // 054 - EXINT11
+	.long ISR_Exint12              // 055 - EXINT12
+	.long ISR_Exint13              // 056 - EXINT13
+	.long ISR_Exint14              // 057 - EXINT14
+	.long ISR_Exint15              // 058 - EXINT15
+	.rept 24
+	.long hang                     // 059 - 082 - IRQx_Handler
+	.endr
+	.long ISR_Dmac0                // 083 - DMAC0
+	.rept 8
+	.long hang                     // 084 - 091 - IRQx_Handler
+	.endr
+	.long ISR_Exint16_19           // 092 - EXINT16 - EXINT19
+	.long ISR_Exint20_23           // 093 - EXINT20 - EXINT23
+	.long ISR_Exint24_27           // 094 - EXINT24 - EXINT27
+	.long ISR_Exint28_31           // 095 - EXINT28 - EXINT31
+	.rept 32
+	.long hang                     // 096 - 127 - IRQx_Handler
 	.endr
 
 .text // Place the following assembler instructions into the text section (code)
@@ -0,0 +1,86 @@
+// kernel_switch.s
+//
+// File contains the context switch of the kernel (see kernel.h):
+//
+// ISR_PendSV - Executes the deferred work and switches from KERNEL_current to KERNEL_next.
+//
+// On exception entry the core has stacked r0 - r3, r12, lr, pc and xPSR on the process stack of the
+// interrupted thread. When the thread has used the fpu, the core has also reserved space for
+// s0 - s15 and FPSCR. These registers are only written when the exception handler uses the fpu
+// (lazy stacking). This routine saves the remaining registers r4 - r11 and EXC_RETURN. s16 - s31
+// are only saved when bit 4 of EXC_RETURN is 0, i.e. when the thread has an fpu context.
+//
+// Stack of a suspended thread (lowest address first):
+//
+// [s16 - s31]  - only with fpu context
+// r4 - r11, EXC_RETURN
+// r0 - r3, r12, lr, pc, xPSR - stacked by the core
+// [s0 - s15, FPSCR, reserved] - only with fpu context, stacked by the core
+//
+// Author: Christian Groeling <ch.groeling@gmail.com>
+
+.syntax unified
+.thumb
+.fpu fpv4-sp-d16
+
+.macro 	FUNCTION name                // this macro makes life less tedious. =)
+		.thumb_func					 // when a function is called by using 'bx' or 'blx' this is mandatory
+		.type \name, %function       // when a function is pointed to from a table, this is mandatory
+		.func \name,\name            // this tells a debugger that the function starts here
+		.fnstart
+		.align						 // make sure the address is aligned for code output
+		\name:                       // this defines the label. the \() is necessary to separate the colon from the label
+		.endm
+
+.macro	ENDFUNC name                 // FUNCTION and ENDFUNC must always be paired
+		.size \name,.-\name 		 // tells the linker how big the code block for the function is
+		.pool                        // let the assembler place constants here
+		.cantunwind
+    	.fnend
+		.endfunc					 // mark the end of the function, so a debugger can display it better
+		.endm
+
+.equ KernelBasepri, 0x40 // KERNEL_CEILING (PRIORITY_TIMER) << (8 - __NVIC_PRIO_BITS), see kernel.h
+
+.text // Place the following assembler instructions into the text section (code)
+
+// The PendSV interrupt service routine. It has the lowest priority, so it never interrupts
+// another interrupt service routine and always returns to a thread.
+FUNCTION ISR_PendSV
+.globl  ISR_PendSV // make the context switch known to the kernel
+	PUSH {r0, lr}               // keep EXC_RETURN, r0 keeps the stack 8 byte aligned
+	BL DEFER_drain              // execute the deferred work, it may ready threads
+	POP {r0, lr}
+
+	MOV r3, #KernelBasepri      // the scheduler must not change KERNEL_next while the switch is done,
+	MSR basepri, r3             // motor control keeps running
+	LDR r2, =KERNEL_current
+	LDR r3, =KERNEL_next
+	LDR r1, [r2]                // r1 = the thread which is suspended
+	LDR r0, [r3]                // r0 = the thread which is resumed
+	CMP r0, r1
+	BEQ done                    // nothing to switch, e.g. the thread was readied again by the deferred work
+
+	CBZ r1, restore             // the context of main() is not saved when the kernel starts
+
+	MRS r12, psp
+	TST lr, #0x10               // bit 4 of EXC_RETURN is 0 when the thread has an fpu context
+	IT eq
+	VSTMDBEQ r12!, {s16-s31}    // triggers the lazy stacking of s0 - s15 as well
+	STMDB r12!, {r4-r11, lr}
+	STR r12, [r1]               // KERNEL_current->stackPointer, it is the first member
+
+restore:
+	STR r0, [r2]                // KERNEL_current = KERNEL_next
+	LDR r12, [r0]               // KERNEL_next->stackPointer
+	LDMIA r12!, {r4-r11, lr}
+	TST lr, #0x10
+	IT eq
+	VLDMIAEQ r12!, {s16-s31}
+	MSR psp, r12
+
+done:
+	MOV r3, #0                  // PendSV is only taken while BASEPRI is 0
+	MSR basepri, r3
+	BX lr                       // the core restores the rest of the context from the process stack
+ENDFUNC ISR_PendSV
@@ -10,4 +10,8 @@
 #include "mb9bf56xr.h"
 #include "system_mb9b560r.h"
 
+#ifdef HOST_SIMULATION
+#include "host.h"
+#endif
+
 #endif
@@ -12,6 +12,8 @@
 #include "base_types.h"
 #include "isr.h"
 #include "error.h"
+#include "cycle_counter.h"
+#include "priority.h"
 
 /// Dummy class which implements an empty isr() method.
 struct InterruptServiceRoutineDummy : public IInterruptServiceRoutine
@@ -24,6 +26,8 @@ struct InterruptServiceRoutineDummy : public IInterruptServiceRoutine
     }
 };
 
+#ifndef HOST_SIMULATION
+// The startup code is replaced by HOST_init() in the host simulation (see host.h).
 
 /// Start address of the data section. This symbol is set by the linker.
 extern uint32_t __data_lma_start;
@@ -49,30 +53,55 @@ extern uint32_t __init_array_end;
 /// Start address of the .ramfuncs initialization section. This symbol is set by the linker.
 extern uint32_t __ramfuncs_lma_start;
 
+/// Start address of the vector table in flash. This symbol is set by the linker.
+extern uint32_t __isr_vectors_start;
+
 /// Start address of the .ramfuncs initialization section. This symbol is set by the linker.
 extern uint32_t __ramfuncs_start;
 
 /// End address of the .ramfuncs section. This symbol is set by the linker.
 extern uint32_t __ramfuncs_end;
+#endif
 
 
 InterruptServiceRoutineDummy isrDummy; ///< Dummy interrupt service routine object which is called when no valid object was registered.
 IInterruptServiceRoutine *pSysTickIsr = &isrDummy; ///< object which is used by the SYSTICK_trampoline.
 
-void ISR_registerSysTick(IInterruptServiceRoutine *sysTickController)
+/// Vector table in ram. It is initialized with the table in flash by ISR_Reset(). The section is not
+/// initialized at startup. The alignment is required by VTOR.
+__attribute__ ((section (".ram_vectors"), aligned (1024))) static uintptr_t ramVectors[ISR_VECTORS];
+
+IInterruptServiceRoutine* ISR_registerSysTick(IInterruptServiceRoutine *sysTickController)
 {
+    IInterruptServiceRoutine* previous = pSysTickIsr;
     pSysTickIsr = sysTickController;
+    return previous;
+}
+
+IsrHandler ISR_install(const IRQn_Type irq, IsrHandler handler)
+{
+    // The irq numbers of the system exceptions are negative. The first irq follows the 16 system entries.
+    const uint32_t index = 16 + irq;
+    const IsrHandler previous = (IsrHandler) ramVectors[index];
+
+    ramVectors[index] = (uintptr_t) handler;
+    __DSB(); // the vector must be written before the next exception is taken
+    return previous;
 }
 
 /// @brief Systick interrupt service routine
 ///
-/// This function calls the registered systick interrupt service routine.
+/// This function calls the registered systick interrupt service routine. Use IsrBinding to
+/// install a routine without this indirection.
 ///
 /// @attention C Linkage is required for all interrupt service routines.
 extern "C" void ISR_Systick()
 {
     // Call registered interrupt service routine
-    pSysTickIsr->isr();
+    if (pSysTickIsr->isr() != RC_OK)
+    {
+        ERROR_handler();
+    }
 }
 
 /// @brief Hard fault interrupt service routine
@@ -134,6 +163,7 @@ extern "C" void ISR_UsageFault()
 
 
 
+#ifndef HOST_SIMULATION
 /// @brief This function handles the reset irq
 ///
 /// When a reset irq is raised (e.g. at startup) this is the first function is called.
@@ -141,8 +171,11 @@ extern "C" void ISR_UsageFault()
 /// * Copy initial values to the data section in ram.
 /// * Initialize the bss ram section with 0.
 /// * Eventually copy ram functions
+/// * Relocate the vector table to ram
 /// * PLL Configuration
+/// * Cycle counter activation
 /// * SysTick Configuration
+/// * Priority grouping and interrupt priorities
 ///
 /// @attention C Linkage is required for interrupt service routines.
 ///
@@ -178,6 +211,18 @@ extern "C" void ISR_Reset()
         *src++ = 0;
     }
 
+    // ------------------------------------------------------------------------------
+    // Relocate the vector table to ram. Static constructors may already install handlers.
+    // ------------------------------------------------------------------------------
+    src = &__isr_vectors_start;
+    dest = (uint32_t*) ramVectors;
+    while (dest < (uint32_t*) &ramVectors[ISR_VECTORS])
+    {
+        *dest++ = *src++;
+    }
+    SCB->VTOR = (uint32_t) ramVectors;
+    __DSB();
+
     // ------------------------------------------------------------------------------
     // Static initialization
     // ------------------------------------------------------------------------------
@@ -195,6 +240,13 @@ extern "C" void ISR_Reset()
     SystemInit();
     SystemCoreClockUpdate();
 
+    // The cycle counter is used for timestamps and time measurements
+    CycleCounter::enable();
+
     // Set the systick to 1 ms
     SysTick_Config(SystemCoreClock / 1000);
+
+    // SysTick_Config() sets the lowest priority for the systick. The plan overrides it.
+    PRIORITY_init();
 }
+#endif
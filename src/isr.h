@@ -8,7 +8,10 @@
 #ifndef __ISR_H__
 #define __ISR_H__
 
+#include "mcu.h"
 #include "return_code.h"
+#include "error.h"
+#include "utils.h"
 
 /// @brief Functions which get called when the system starts.
 ///
@@ -22,6 +25,12 @@
 
 
 
+/// Number of entries of the vector table: the initial stack pointer, 15 system exceptions and 128 irqs.
+#define ISR_VECTORS (16 + 128)
+
+/// Type of an interrupt service routine which is called directly through the vector table.
+typedef void (*IsrHandler)();
+
 /// @brief A simple interface to be used for defining interrupt service routines (methods).
 struct IInterruptServiceRoutine
 {
@@ -32,7 +41,67 @@ struct IInterruptServiceRoutine
 /// @brief This function registers an object which implements the IInterrruptServiceRoutine interface.
 ///
 /// After successful registration the method isr() of the given objects is called each time a
-/// systick irq is raised.
-void ISR_registerSysTick(IInterruptServiceRoutine *sysTickController);
+/// systick irq is raised. Only one object can be registered, the registration replaces the previous
+/// one. Periodic work should be subscribed with SysTickController::subscribe() instead.
+///
+/// @param sysTickController The object whose isr() is called.
+/// @returns The previously registered object.
+IInterruptServiceRoutine* ISR_registerSysTick(IInterruptServiceRoutine *sysTickController);
+
+/// @brief This function installs an interrupt service routine in the vector table.
+///
+/// At startup ISR_Reset() copies the vector table from flash to ram and points VTOR to the copy.
+/// The installed routine is called directly by the nvic, no trampoline is involved. Vectors are
+/// fetched from ram without flash wait states.
+///
+/// The change is effective for the next exception. The irq should be disabled in the nvic while
+/// its routine is changed.
+///
+/// @param irq The irq or system exception (e.g. BT1_IRQn, SysTick_IRQn) as defined in mb9bf56xr.h.
+/// @param handler The interrupt service routine. It must have C linkage or be a static function.
+/// @returns The previously installed interrupt service routine.
+IsrHandler ISR_install(const IRQn_Type irq, IsrHandler handler);
+
+/// @brief This template class binds a function to a vector at compile time.
+///
+/// A routine which is registered with ISR_registerSysTick() is reached through a trampoline, a global
+/// pointer and a vtable. IsrBinding::entry() calls the bound function directly. The function is known
+/// at compile time, so gcc inlines its body into entry(). The nvic jumps into the body without any
+/// indirection:
+///
+/// @code
+/// IsrBinding<&SysTickController::tick>::install(SysTick_IRQn);
+/// @endcode
+///
+/// The bound function can be a free function or a static method. It should be declared INLINE or
+/// STATIC_INLINE and must be visible where the binding is installed. ERROR_handler() is called
+/// when it does not return RC_OK.
+///
+/// @tparam handler The function which is executed when the irq is raised.
+template<ReturnCode (*handler)()>
+    struct IsrBinding
+    {
+        /// The interrupt service routine which is installed in the vector table.
+        static void entry()
+        {
+            if (handler() != RC_OK)
+            {
+                ERROR_handler();
+            }
+        }
+
+        /// @brief Installs entry() in the vector table (see ISR_install()).
+        ///
+        /// @param irq The irq or system exception.
+        /// @returns The previously installed interrupt service routine.
+        STATIC_INLINE IsrHandler install(const IRQn_Type irq)
+        {
+            return ISR_install(irq, &entry);
+        }
+
+    private:
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        IsrBinding();
+    };
 
 #endif
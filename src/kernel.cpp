@@ -0,0 +1,540 @@
+/// @file
+///
+/// @brief This file contains the implementation of the preemptive kernel.
+///
+/// The context switch is implemented in kernel_switch.s.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Kernel
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "error.h"
+#include "isr.h"
+#include "kernel.h"
+#include "priority.h"
+#include "systick.h"
+
+/// The critical section which protects the kernel data.
+typedef CriticalSection<KERNEL_CEILING> KernelLock;
+
+static_assert((KERNEL_CEILING << (8u - __NVIC_PRIO_BITS)) == 0x40u, "KernelBasepri in kernel_switch.s must match the ceiling");
+
+/// Initial xPSR of a thread. Only the thumb bit is set.
+static const uint32_t THREAD_XPSR = 0x01000000u;
+
+/// EXC_RETURN of a thread which did not use the fpu: thread mode, process stack, basic frame.
+static const uint32_t THREAD_EXC_RETURN = 0xFFFFFFFDu;
+
+/// Number of words the context switch stores for a thread without fpu context: r4 - r11 and EXC_RETURN.
+static const uint32_t SOFTWARE_FRAME_WORDS = 9u;
+
+/// Number of words the core stores on exception entry without fpu context: r0 - r3, r12, lr, pc and xPSR.
+static const uint32_t HARDWARE_FRAME_WORDS = 8u;
+
+extern "C" KernelThread* volatile KERNEL_current;
+extern "C" KernelThread* volatile KERNEL_next;
+
+KernelThread* volatile KERNEL_current;
+KernelThread* volatile KERNEL_next;
+
+static KernelList readyLists[KERNEL_PRIORITIES]; ///< The ready threads of each priority.
+static uint32_t readyPriorities; ///< Bit p is set when a thread with priority p is ready.
+static KernelList sleepers; ///< The sleeping threads, the earliest wake tick first.
+static volatile uint32_t ticks; ///< Number of ticks since the kernel was started.
+static boolean_t started; ///< TRUE when the kernel runs.
+
+static KernelThread idleThread; ///< The idle thread. It runs when no other thread is ready.
+static uint64_t idleStack[KERNEL_IDLE_STACK_SIZE / sizeof(uint64_t)]; ///< The stack of the idle thread.
+
+/// The context switch. It is installed as PendSV routine by KERNEL_start().
+extern "C" void ISR_PendSV();
+
+/// Appends a thread to a list.
+static void append(KernelList& list, KernelThread* thread)
+{
+    thread->next = NULL;
+    thread->previous = list.tail;
+    if (list.tail != NULL)
+    {
+        list.tail->next = thread;
+    }
+    else
+    {
+        list.head = thread;
+    }
+    list.tail = thread;
+    thread->list = &list;
+}
+
+/// Inserts a thread behind all threads with the same or a higher priority.
+static void insertByPriority(KernelList& list, KernelThread* thread)
+{
+    KernelThread* successor = list.head;
+    while (successor != NULL && successor->priority >= thread->priority)
+    {
+        successor = successor->next;
+    }
+
+    if (successor == NULL)
+    {
+        append(list, thread);
+        return;
+    }
+
+    thread->next = successor;
+    thread->previous = successor->previous;
+    if (successor->previous != NULL)
+    {
+        successor->previous->next = thread;
+    }
+    else
+    {
+        list.head = thread;
+    }
+    successor->previous = thread;
+    thread->list = &list;
+}
+
+/// Removes a thread from the list which contains it.
+static void remove(KernelThread* thread)
+{
+    KernelList& list = *thread->list;
+    if (thread->previous != NULL)
+    {
+        thread->previous->next = thread->next;
+    }
+    else
+    {
+        list.head = thread->next;
+    }
+    if (thread->next != NULL)
+    {
+        thread->next->previous = thread->previous;
+    }
+    else
+    {
+        list.tail = thread->previous;
+    }
+    thread->list = NULL;
+}
+
+/// Returns TRUE when a thread is in one of the ready lists.
+static INLINE boolean_t isReady(const KernelThread* thread)
+{
+    return thread->list == &readyLists[thread->priority];
+}
+
+/// Appends a thread to the ready list of its priority.
+static void makeReady(KernelThread* thread)
+{
+    append(readyLists[thread->priority], thread);
+    readyPriorities |= 1u << thread->priority;
+}
+
+/// Removes a thread from its ready list.
+static void makeUnready(KernelThread* thread)
+{
+    remove(thread);
+    if (readyLists[thread->priority].head == NULL)
+    {
+        readyPriorities &= ~(1u << thread->priority);
+    }
+}
+
+/// @brief Selects the ready thread with the highest priority and pends the context switch when it does not run.
+///
+/// The idle thread is always ready, so the bitmap is never empty.
+static void schedule()
+{
+    KernelThread* next = readyLists[31u - __CLZ(readyPriorities)].head;
+    KERNEL_next = next;
+    if (started && next != KERNEL_current)
+    {
+        // The next thread must resume in thread mode. The event loop may sleep on exit (see EVENT_run()).
+        SCB->SCR &= ~SCB_SCR_SLEEPONEXIT_Msk;
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    }
+}
+
+/// @brief Checks that the caller may block: a thread with all interrupts enabled.
+///
+/// Blocking calls from interrupt service routines or critical sections would not wait, the context
+/// switch is only taken in thread mode when nothing masks PendSV. ERROR_handler() is called otherwise.
+static INLINE void checkBlockingCall()
+{
+    if (__get_IPSR() != 0u || __get_BASEPRI() != 0u || __get_PRIMASK() != 0u)
+    {
+        ERROR_handler();
+    }
+}
+
+/// @brief Changes the actual priority of a thread. The thread keeps its position relative to the other threads.
+///
+/// @param thread The thread.
+/// @param priority The new priority.
+static void setPriority(KernelThread* thread, const uint8_t priority)
+{
+    if (thread->priority == priority)
+    {
+        return;
+    }
+
+    if (isReady(thread))
+    {
+        makeUnready(thread);
+        thread->priority = priority;
+        makeReady(thread);
+    }
+    else if (thread->list != NULL && thread->list != &sleepers)
+    {
+        // The thread waits for a mutex or a semaphore. The wait lists are ordered by priority.
+        KernelList& list = *thread->list;
+        remove(thread);
+        thread->priority = priority;
+        insertByPriority(list, thread);
+    }
+    else
+    {
+        thread->priority = priority;
+    }
+}
+
+/// Returns the priority of a thread including the priorities which are inherited through its mutexes.
+static uint8_t getInheritedPriority(const KernelThread* thread)
+{
+    uint8_t priority = thread->basePriority;
+    for (const KernelMutex* mutex = thread->mutexes; mutex != NULL; mutex = mutex->next)
+    {
+        if (mutex->waiters.head != NULL && mutex->waiters.head->priority > priority)
+        {
+            priority = mutex->waiters.head->priority;
+        }
+    }
+    return priority;
+}
+
+/// Makes a thread the owner of a mutex.
+static void takeMutex(KernelMutex& mutex, KernelThread* thread)
+{
+    mutex.owner = thread;
+    mutex.next = thread->mutexes;
+    thread->mutexes = &mutex;
+    thread->blockedOn = NULL;
+}
+
+/// Blocks the running thread until its wake tick.
+static void suspend(KernelThread* thread)
+{
+    makeUnready(thread);
+
+    KernelThread* successor = sleepers.head;
+    while (successor != NULL && (int32_t) (successor->wakeTick - thread->wakeTick) <= 0)
+    {
+        successor = successor->next;
+    }
+
+    if (successor == NULL)
+    {
+        append(sleepers, thread);
+    }
+    else
+    {
+        thread->next = successor;
+        thread->previous = successor->previous;
+        if (successor->previous != NULL)
+        {
+            successor->previous->next = thread;
+        }
+        else
+        {
+            sleepers.head = thread;
+        }
+        successor->previous = thread;
+        thread->list = &sleepers;
+    }
+}
+
+/// @brief Ends the running thread. The entry function of each thread returns to this function.
+///
+/// A thread must not end while it owns mutexes, the waiters would never get them. ERROR_handler() is
+/// called in this case.
+static void exitThread()
+{
+    if (KERNEL_current->mutexes != NULL)
+    {
+        ERROR_handler();
+    }
+
+    {
+        KernelLock lock;
+        makeUnready(KERNEL_current);
+        schedule();
+    }
+
+    // The context switch is taken when the lock is released. The thread never runs again.
+    while (1)
+    {
+    }
+}
+
+/// The entry function of the idle thread.
+static void idle(void*)
+{
+    while (1)
+    {
+        __WFI();
+    }
+}
+
+/// This class advances the kernel time. It is subscribed to the systick.
+struct KernelTicker : public ITicklessSubscriber
+{
+    /// Implements IInterruptServiceRoutine::isr()
+    ReturnCode isr()
+    {
+        KernelLock lock;
+        const uint32_t now = ticks + 1u;
+        ticks = now;
+
+        while (sleepers.head != NULL && (int32_t) (now - sleepers.head->wakeTick) >= 0)
+        {
+            KernelThread* thread = sleepers.head;
+            remove(thread);
+            makeReady(thread);
+        }
+
+        // Round robin: the running thread goes behind the other threads of its priority.
+        KernelThread* current = KERNEL_current;
+        if (current != NULL && isReady(current) && current->next != NULL)
+        {
+            makeUnready(current);
+            makeReady(current);
+        }
+
+        schedule();
+        return RC_OK;
+    }
+
+    /// Implements ITicklessSubscriber::getIdleTicks()
+    uint32_t getIdleTicks()
+    {
+        KernelLock lock;
+        KernelThread* current = KERNEL_current;
+        if (current != NULL && isReady(current) && readyLists[current->priority].head != readyLists[current->priority].tail)
+        {
+            return 1u; // round robin
+        }
+        if (sleepers.head == NULL)
+        {
+            return SYSTICK_IDLE_FOREVER;
+        }
+        const int32_t remaining = (int32_t) (sleepers.head->wakeTick - ticks);
+        return (remaining > 1) ? (uint32_t) remaining : 1u;
+    }
+
+    /// Implements ITicklessSubscriber::skipTicks()
+    void skipTicks(const uint32_t count)
+    {
+        KernelLock lock;
+        ticks = ticks + count;
+    }
+};
+
+static KernelTicker ticker; ///< The systick subscriber of the kernel.
+
+void KERNEL_init()
+{
+    KERNEL_createThread(idleThread, &idle, NULL, idleStack, sizeof(idleStack), 0u);
+}
+
+void KERNEL_createThread(KernelThread& thread, KernelEntry entry, void* argument, void* stack, const uint32_t size,
+        const uint8_t priority)
+{
+    // The initial context looks like the thread was interrupted right before its entry function.
+    uint32_t* top = (uint32_t*) ((uintptr_t) ((uint8_t*) stack + size) & ~(uintptr_t) 7u);
+    uint32_t* frame = top - HARDWARE_FRAME_WORDS - SOFTWARE_FRAME_WORDS;
+
+    for (uint32_t i = 0; i < SOFTWARE_FRAME_WORDS + HARDWARE_FRAME_WORDS; i++)
+    {
+        frame[i] = 0u;
+    }
+    frame[8] = THREAD_EXC_RETURN; // lr of the software frame
+    uint32_t* hardwareFrame = frame + SOFTWARE_FRAME_WORDS;
+    hardwareFrame[0] = (uint32_t) (uintptr_t) argument; // r0
+    hardwareFrame[5] = (uint32_t) (uintptr_t) &exitThread; // lr
+    hardwareFrame[6] = (uint32_t) (uintptr_t) entry & ~1u; // pc, the thumb bit is in xPSR
+    hardwareFrame[7] = THREAD_XPSR;
+
+    thread.stackPointer = frame;
+    thread.mutexes = NULL;
+    thread.blockedOn = NULL;
+    thread.priority = priority;
+    thread.basePriority = priority;
+
+    KernelLock lock;
+    makeReady(&thread);
+    schedule();
+}
+
+void KERNEL_start()
+{
+    ISR_install(PendSV_IRQn, &ISR_PendSV);
+    if (!SysTickController::subscribe(&ticker, 1u, 0u))
+    {
+        ERROR_handler();
+    }
+
+    {
+        KernelLock lock;
+        started = TRUE;
+        KERNEL_current = NULL; // the context of main() is not saved
+        schedule();
+    }
+
+    // The context switch is taken when the lock is released.
+    while (1)
+    {
+    }
+}
+
+uint32_t KERNEL_getTicks()
+{
+    return ticks;
+}
+
+void KERNEL_yield()
+{
+    checkBlockingCall();
+    KernelLock lock;
+    KernelThread* current = KERNEL_current;
+    makeUnready(current);
+    makeReady(current);
+    schedule();
+}
+
+void KERNEL_sleep(const uint32_t duration)
+{
+    checkBlockingCall();
+    if (duration == 0u)
+    {
+        KERNEL_yield();
+        return;
+    }
+
+    KernelLock lock;
+    KernelThread* current = KERNEL_current;
+    current->wakeTick = ticks + duration;
+    suspend(current);
+    schedule();
+}
+
+void KERNEL_lock(KernelMutex& mutex)
+{
+    checkBlockingCall();
+    KernelLock lock;
+    KernelThread* current = KERNEL_current;
+
+    if (mutex.owner == NULL)
+    {
+        takeMutex(mutex, current);
+        return;
+    }
+    if (mutex.owner == current)
+    {
+        ERROR_handler();
+    }
+
+    makeUnready(current);
+    insertByPriority(mutex.waiters, current);
+    current->blockedOn = &mutex;
+
+    // Pass the priority on along the chain of blocked owners.
+    for (KernelThread* owner = mutex.owner; owner != NULL && owner->priority < current->priority;
+            owner = (owner->blockedOn != NULL) ? owner->blockedOn->owner : NULL)
+    {
+        setPriority(owner, current->priority);
+    }
+
+    schedule();
+    // The context switch is taken when the lock is released. The thread continues as owner of the mutex.
+}
+
+void KERNEL_unlock(KernelMutex& mutex)
+{
+    KernelLock lock;
+    KernelThread* current = KERNEL_current;
+
+    if (mutex.owner != current)
+    {
+        ERROR_handler();
+    }
+
+    KernelMutex** link = &current->mutexes;
+    while (*link != &mutex)
+    {
+        link = &(*link)->next;
+    }
+    *link = mutex.next;
+
+    KernelThread* waiter = mutex.waiters.head;
+    if (waiter != NULL)
+    {
+        remove(waiter);
+        takeMutex(mutex, waiter);
+        // The new owner inherits from the remaining waiters.
+        setPriority(waiter, getInheritedPriority(waiter));
+        makeReady(waiter);
+    }
+    else
+    {
+        mutex.owner = NULL;
+    }
+
+    setPriority(current, getInheritedPriority(current));
+    schedule();
+}
+
+void KERNEL_wait(KernelSemaphore& semaphore)
+{
+    checkBlockingCall();
+    KernelLock lock;
+    if (semaphore.count != 0u)
+    {
+        semaphore.count--;
+        return;
+    }
+
+    KernelThread* current = KERNEL_current;
+    makeUnready(current);
+    insertByPriority(semaphore.waiters, current);
+    schedule();
+    // The context switch is taken when the lock is released. The unit is passed by KERNEL_signal().
+}
+
+boolean_t KERNEL_tryWait(KernelSemaphore& semaphore)
+{
+    KernelLock lock;
+    if (semaphore.count == 0u)
+    {
+        return FALSE;
+    }
+    semaphore.count--;
+    return TRUE;
+}
+
+void KERNEL_signal(KernelSemaphore& semaphore)
+{
+    KernelLock lock;
+    KernelThread* waiter = semaphore.waiters.head;
+    if (waiter == NULL)
+    {
+        semaphore.count++;
+        return;
+    }
+
+    remove(waiter);
+    makeReady(waiter);
+    schedule();
+}
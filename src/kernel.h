@@ -0,0 +1,226 @@
+/// @file
+///
+/// @brief This file contains the preemptive kernel.
+///
+/// The kernel runs threads with fixed priorities. The ready thread with the highest priority runs.
+/// Threads of the same priority share the cpu round robin, one systick per turn.
+///
+/// * Threads - Each thread has its own stack and runs on the process stack pointer (PSP). The
+///   interrupt service routines keep running on the main stack which is set up by ISR_Reset().
+/// * Context switch - The scheduler pends PendSV, which has the lowest priority. The PendSV routine
+///   (kernel_switch.s) saves r4 - r11 on the stack of the actual thread and restores them from the
+///   stack of the next one. The fpu registers s16 - s31 are only saved for threads which have used
+///   the fpu. The core stacks s0 - s15 lazily, i.e. only when the fpu is used by the interrupted code.
+///   The deferred work (see defer.h) is executed before each switch.
+/// * Ready queue - One list per priority and a bitmap of the non empty lists. The highest priority
+///   is found with a single clz.
+/// * Mutexes - The owner of a mutex inherits the priority of the highest waiting thread. The
+///   inheritance is passed on along chains of blocked owners.
+/// * Semaphores - Counting semaphores. They can be signaled by interrupt service routines.
+/// * Time - The kernel is a systick subscriber with a period of one tick.
+///
+/// The kernel is started at the end of main():
+///
+/// @code
+/// static KernelThread worker;
+/// static uint64_t workerStack[128];
+///
+/// static void work(void* argument)
+/// {
+///     while (1)
+///     {
+///         ...
+///         KERNEL_sleep(10);
+///     }
+/// }
+///
+/// int main()
+/// {
+///     ...
+///     KERNEL_init();
+///     KERNEL_createThread(worker, &work, NULL, workerStack, sizeof(workerStack), 5);
+///     KERNEL_start(); // does not return
+/// }
+/// @endcode
+///
+/// All kernel data is protected with a CriticalSection at KERNEL_CEILING. Interrupt service routines
+/// with a higher priority must not call kernel functions.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Kernel
+
+#ifndef __KERNEL_H__
+#define __KERNEL_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "priority.h"
+
+/// @brief This module contains the preemptive kernel.
+///
+/// @defgroup Kernel Kernel
+
+/// Number of thread priorities. 0 is the lowest priority. It is used by the idle thread.
+/// @ingroup Kernel
+#define KERNEL_PRIORITIES 32
+
+/// The ceiling priority of the kernel data. Only interrupt service routines with this or a lower
+/// priority may call kernel functions.
+/// @ingroup Kernel
+#define KERNEL_CEILING PRIORITY_TIMER
+
+/// Size of the stack of the idle thread in bytes.
+/// @ingroup Kernel
+#define KERNEL_IDLE_STACK_SIZE 512
+
+/// Type of the entry function of a thread. The thread ends when the function returns.
+/// @ingroup Kernel
+typedef void (*KernelEntry)(void* argument);
+
+struct KernelThread;
+struct KernelMutex;
+
+/// This struct is an intrusive list of threads.
+/// @ingroup Kernel
+struct KernelList
+{
+    KernelThread* head; ///< The first thread. NULL when the list is empty.
+    KernelThread* tail; ///< The last thread.
+};
+
+/// This struct contains the state of a thread. The content is private to the kernel.
+/// @ingroup Kernel
+struct KernelThread
+{
+    uint32_t* stackPointer; ///< The saved stack pointer. Must be the first member, it is used by the context switch.
+    KernelThread* next; ///< The next thread of the list which contains the thread.
+    KernelThread* previous; ///< The previous thread of the list which contains the thread.
+    KernelList* list; ///< The list which contains the thread. NULL when the thread has ended. The running thread stays in its ready list.
+    KernelMutex* mutexes; ///< The mutexes which are owned by the thread.
+    KernelMutex* blockedOn; ///< The mutex the thread waits for.
+    uint32_t wakeTick; ///< The tick at which a sleeping thread becomes ready.
+    uint8_t priority; ///< The actual priority. It is raised by priority inheritance.
+    uint8_t basePriority; ///< The priority which was assigned at creation.
+};
+
+/// This struct contains the state of a mutex. The content is private to the kernel.
+/// @ingroup Kernel
+struct KernelMutex
+{
+    KernelThread* owner; ///< The thread which owns the mutex. NULL when it is free.
+    KernelMutex* next; ///< The next mutex which is owned by the same thread.
+    KernelList waiters; ///< The waiting threads, the highest priority first.
+};
+
+/// This struct contains the state of a counting semaphore. The content is private to the kernel.
+/// @ingroup Kernel
+struct KernelSemaphore
+{
+    /// @brief Constructor
+    ///
+    /// @param count The initial count.
+    explicit KernelSemaphore(const uint32_t count) :
+            count(count), waiters()
+    {
+    }
+
+    uint32_t count; ///< The number of available units.
+    KernelList waiters; ///< The waiting threads, the highest priority first.
+};
+
+/// The thread which runs. It is written by the context switch only.
+/// @ingroup Kernel
+extern "C" KernelThread* volatile KERNEL_current;
+
+/// The thread which runs after the next context switch.
+/// @ingroup Kernel
+extern "C" KernelThread* volatile KERNEL_next;
+
+/// @brief This function initializes the kernel and creates the idle thread.
+///
+/// It must be called before any other kernel function.
+/// @ingroup Kernel
+void KERNEL_init();
+
+/// @brief This function creates a thread. The thread is ready immediately.
+///
+/// The thread must unlock all its mutexes before its entry function returns. ERROR_handler() is
+/// called otherwise.
+///
+/// When the kernel runs and the thread has a higher priority than the calling thread, the new
+/// thread runs before this function returns.
+///
+/// @param thread The thread. It must stay valid while the thread runs.
+/// @param entry The entry function.
+/// @param argument The argument which is passed to the entry function.
+/// @param stack The stack. It must be 8 byte aligned.
+/// @param size The size of the stack in bytes. Threads which use the fpu need at least 200 bytes for the context.
+/// @param priority The priority (1 - KERNEL_PRIORITIES - 1).
+/// @ingroup Kernel
+void KERNEL_createThread(KernelThread& thread, KernelEntry entry, void* argument, void* stack, const uint32_t size,
+        const uint8_t priority);
+
+/// @brief This function starts the kernel. It does not return.
+///
+/// The PendSV routine is replaced by the context switch. The stack of main() is not used anymore.
+/// @ingroup Kernel
+void KERNEL_start();
+
+/// @brief This function returns the number of ticks since the kernel was started.
+/// @ingroup Kernel
+uint32_t KERNEL_getTicks();
+
+/// @brief This function moves the calling thread to the end of the threads with the same priority.
+///
+/// The blocking functions (KERNEL_yield(), KERNEL_sleep(), KERNEL_lock() and KERNEL_wait()) must only
+/// be called by threads with all interrupts enabled. They call ERROR_handler() otherwise.
+/// @ingroup Kernel
+void KERNEL_yield();
+
+/// @brief This function suspends the calling thread.
+///
+/// @param ticks The number of ticks. 0 has the same effect as KERNEL_yield().
+/// @ingroup Kernel
+void KERNEL_sleep(const uint32_t ticks);
+
+/// @brief This function locks a mutex. The calling thread waits until the mutex is free.
+///
+/// While the thread waits, the owner of the mutex runs at least with the priority of the thread.
+///
+/// @attention Mutexes are not recursive. Locking an owned mutex calls ERROR_handler().
+///
+/// @param mutex The mutex.
+/// @ingroup Kernel
+void KERNEL_lock(KernelMutex& mutex);
+
+/// @brief This function unlocks a mutex which is owned by the calling thread.
+///
+/// The mutex is passed to the waiting thread with the highest priority.
+///
+/// @param mutex The mutex.
+/// @ingroup Kernel
+void KERNEL_unlock(KernelMutex& mutex);
+
+/// @brief This function takes a unit of a semaphore. The calling thread waits until a unit is available.
+///
+/// @param semaphore The semaphore.
+/// @ingroup Kernel
+void KERNEL_wait(KernelSemaphore& semaphore);
+
+/// @brief This function takes a unit of a semaphore without waiting.
+///
+/// @param semaphore The semaphore.
+/// @returns TRUE when a unit was taken, FALSE when no unit is available.
+/// @ingroup Kernel
+boolean_t KERNEL_tryWait(KernelSemaphore& semaphore);
+
+/// @brief This function releases a unit of a semaphore. It can be called by interrupt service routines.
+///
+/// The unit is passed to the waiting thread with the highest priority.
+///
+/// @param semaphore The semaphore.
+/// @ingroup Kernel
+void KERNEL_signal(KernelSemaphore& semaphore);
+
+#endif
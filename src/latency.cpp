@@ -0,0 +1,95 @@
+/// @file
+///
+/// @brief This file contains the implementation of the interrupt latency monitor.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Latency
+
+#include <stdio.h>
+#include <stdint.h>
+#include "latency.h"
+
+/// The first histogram of the list. It is zero initialized before the static constructors run.
+static LatencyHistogram* firstHistogram;
+
+LatencyHistogram::LatencyHistogram(const IRQn_Type irq) :
+        irq(irq), count(0), entry(), execution(), maxEntry(0), maxExecution(0), next(firstHistogram)
+{
+    firstHistogram = this;
+}
+
+LatencyHistogram* LATENCY_find(const IRQn_Type irq)
+{
+    for (LatencyHistogram* histogram = firstHistogram; histogram != NULL; histogram = histogram->next)
+    {
+        if (histogram->irq == irq)
+        {
+            return histogram;
+        }
+    }
+    return NULL;
+}
+
+void LATENCY_reset(LatencyHistogram& histogram)
+{
+    histogram.count = 0u;
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        histogram.entry[i] = 0u;
+        histogram.execution[i] = 0u;
+    }
+    histogram.maxEntry = 0u;
+    histogram.maxExecution = 0u;
+}
+
+uint32_t LATENCY_getPercentile(const LatencyHistogram& histogram, const uint32_t percent)
+{
+    // Number of executions which must be covered. Rounded up, so that the percentile is never too low.
+    const uint32_t required = (uint32_t) (((uint64_t) histogram.count * percent + 99u) / 100u);
+    if (required == 0u)
+    {
+        return 0u;
+    }
+
+    uint32_t covered = 0u;
+    for (uint32_t i = 0; i < LATENCY_BUCKETS - 1u; i++)
+    {
+        covered += histogram.entry[i];
+        if (covered >= required)
+        {
+            return ((i + 1u) << LATENCY_ENTRY_SHIFT) - 1u;
+        }
+    }
+    return UINT32_MAX;
+}
+
+/// @brief Writes the buckets of a histogram to stdout.
+///
+/// @param name The name of the histogram which is printed.
+/// @param buckets The buckets.
+/// @param shift The width of a bucket: 2^shift cycles.
+static void dumpBuckets(const char* name, const uint32_t* buckets, const uint32_t shift)
+{
+    printf("  %s:", name);
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        if (buckets[i] != 0u)
+        {
+            printf(" %lu%s:%lu", (unsigned long) (i << shift), (i == LATENCY_BUCKETS - 1u) ? "+" : "",
+                    (unsigned long) buckets[i]);
+        }
+    }
+    printf("\n");
+}
+
+void LATENCY_dump()
+{
+    for (const LatencyHistogram* histogram = firstHistogram; histogram != NULL; histogram = histogram->next)
+    {
+        printf("irq %d: %lu executions, max latency %lu cycles, max execution %lu cycles\n", (int) histogram->irq,
+                (unsigned long) histogram->count, (unsigned long) histogram->maxEntry,
+                (unsigned long) histogram->maxExecution);
+        dumpBuckets("latency", histogram->entry, LATENCY_ENTRY_SHIFT);
+        dumpBuckets("execution", histogram->execution, LATENCY_EXECUTION_SHIFT);
+    }
+}
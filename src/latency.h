@@ -0,0 +1,227 @@
+/// @file
+///
+/// @brief This file contains the interrupt latency monitor.
+///
+/// The monitor measures how late an interrupt service routine starts and how long it runs. A
+/// ScopedLatency object at the start of the routine reads the trigger when it is constructed and
+/// records both times into a LatencyHistogram when it goes out of scope:
+///
+/// @code
+/// LatencyHistogram timerLatency(BT1_IRQn);
+///
+/// extern "C" void ISR_BaseTimer1()
+/// {
+///     ScopedLatency<LatencyTriggerBaseTimer<FM4_BT1_RT_BASE> > latency(timerLatency);
+///     ...
+/// }
+/// @endcode
+///
+/// * Latency - cycles from the expected trigger to the entry of the routine. The trigger is
+///   reconstructed from the counter which raised the irq: a down counter that reloaded at the
+///   trigger has counted reload - value cycles since then.
+/// * Execution time - cycles of the dwt cycle counter from the entry to the end of the scope.
+///
+/// Each time is sorted into LATENCY_BUCKETS buckets of fixed width. The last bucket collects all
+/// longer times. All histograms are linked into a list and can be found by their irq at runtime.
+///
+/// The monitor is only active when the macro ENABLE_LATENCY_MONITOR is defined (see Makefile).
+/// Otherwise ScopedLatency compiles to nothing.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Latency
+
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "cycle_counter.h"
+#include "utils.h"
+
+/// @brief This module contains the interrupt latency monitor.
+///
+/// @defgroup Latency Interrupt Latency Monitor
+
+/// Number of buckets of each histogram.
+/// @ingroup Latency
+#define LATENCY_BUCKETS 16
+
+/// Width of a latency bucket: 2^LATENCY_ENTRY_SHIFT cycles.
+/// @ingroup Latency
+#define LATENCY_ENTRY_SHIFT 3
+
+/// Width of an execution time bucket: 2^LATENCY_EXECUTION_SHIFT cycles.
+/// @ingroup Latency
+#define LATENCY_EXECUTION_SHIFT 5
+
+/// @brief This class contains the histograms of one interrupt service routine.
+///
+/// The histograms are written by a single routine and read in thread mode. Each counter is a single
+/// word, so a reader never sees a torn counter. The counters of one histogram may be read while a
+/// record is written.
+/// @ingroup Latency
+struct LatencyHistogram
+{
+    /// @brief Constructor. The histogram is added to the list of all histograms.
+    ///
+    /// @param irq The irq or system exception of the measured routine.
+    explicit LatencyHistogram(const IRQn_Type irq);
+
+    /// @brief Records one execution of the routine.
+    ///
+    /// @param latency Cycles from the trigger to the entry of the routine.
+    /// @param execution Execution time of the routine in cycles.
+    INLINE void record(const uint32_t latency, const uint32_t execution)
+    {
+        entry[getBucket(latency >> LATENCY_ENTRY_SHIFT)]++;
+        this->execution[getBucket(execution >> LATENCY_EXECUTION_SHIFT)]++;
+        if (latency > maxEntry)
+        {
+            maxEntry = latency;
+        }
+        if (execution > maxExecution)
+        {
+            maxExecution = execution;
+        }
+        count++;
+    }
+
+    const IRQn_Type irq; ///< The irq of the measured routine.
+    uint32_t count; ///< Number of recorded executions.
+    uint32_t entry[LATENCY_BUCKETS]; ///< Latency histogram. Bucket b counts latencies of b * 2^LATENCY_ENTRY_SHIFT cycles and more.
+    uint32_t execution[LATENCY_BUCKETS]; ///< Execution time histogram. Bucket b counts times of b * 2^LATENCY_EXECUTION_SHIFT cycles and more.
+    uint32_t maxEntry; ///< The longest latency in cycles.
+    uint32_t maxExecution; ///< The longest execution time in cycles.
+    LatencyHistogram* next; ///< The next histogram of the list.
+
+private:
+    /// Returns the bucket of a scaled time. Longer times are collected by the last bucket.
+    STATIC_INLINE uint32_t getBucket(const uint32_t scaled)
+    {
+        return (scaled < LATENCY_BUCKETS) ? scaled : LATENCY_BUCKETS - 1u;
+    }
+
+    /// The histogram must not be copied. The copy would not be part of the list.
+    LatencyHistogram(const LatencyHistogram&);
+
+    /// The histogram must not be copied. The copy would not be part of the list.
+    LatencyHistogram& operator=(const LatencyHistogram&);
+};
+
+/// @brief This function searches the histogram of an irq.
+///
+/// @param irq The irq or system exception.
+/// @returns The histogram or NULL when the routine of the irq is not monitored.
+/// @ingroup Latency
+LatencyHistogram* LATENCY_find(const IRQn_Type irq);
+
+/// @brief This function clears all counters of a histogram.
+///
+/// @attention Records which are written while the histogram is cleared can be lost.
+///
+/// @param histogram The histogram.
+/// @ingroup Latency
+void LATENCY_reset(LatencyHistogram& histogram);
+
+/// @brief This function returns the latency which is not exceeded by a given share of the executions.
+///
+/// The result is the upper limit of the bucket which contains the percentile. It can be compared
+/// directly with the latency budget of the routine.
+///
+/// @param histogram The histogram.
+/// @param percent The share of the executions (1 - 100).
+/// @returns The latency in cycles, 0 when nothing was recorded or UINT32_MAX when the percentile is in the last bucket.
+/// @ingroup Latency
+uint32_t LATENCY_getPercentile(const LatencyHistogram& histogram, const uint32_t percent);
+
+/// @brief This function writes all histograms to stdout.
+/// @ingroup Latency
+void LATENCY_dump();
+
+/// @brief This class is the trigger of the systick irq.
+///
+/// The systick counts the core clock down and is reloaded when the irq is raised.
+/// @ingroup Latency
+struct LatencyTriggerSysTick
+{
+    /// Returns the cycles since the last irq.
+    STATIC_INLINE uint32_t elapsed()
+    {
+        return SysTick->LOAD - SysTick->VAL;
+    }
+
+private:
+    /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+    LatencyTriggerSysTick();
+};
+
+/// @brief This template class is the trigger of a base timer in reload mode.
+///
+/// The timer counts down from PCSR and raises the underflow irq when it is reloaded. The count
+/// clock is PCLK1 without prescaler (TMCR.CKS = 0). It is converted into core cycles.
+///
+/// @attention PCSR must not be changed before the routine was entered, otherwise the reload value
+/// of the actual period is unknown.
+///
+/// @tparam base The base address of the timer (e.g. FM4_BT1_RT_BASE).
+/// @ingroup Latency
+template<uint32_t base>
+    struct LatencyTriggerBaseTimer
+    {
+        /// Returns the cycles since the last underflow.
+        STATIC_INLINE uint32_t elapsed()
+        {
+            const FM_BT_RT_TypeDef* timer = (const FM_BT_RT_TypeDef*) base;
+            return (uint32_t) (timer->PCSR - timer->TMR) << (APBC1_PSR_Val & 0x3ul);
+        }
+
+    private:
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        LatencyTriggerBaseTimer();
+    };
+
+/// @brief This template class measures the latency and the execution time of an interrupt service routine.
+///
+/// The object must be the first statement of the routine. The execution time ends when it goes
+/// out of scope.
+///
+/// @tparam Trigger The trigger of the irq (LatencyTriggerSysTick or LatencyTriggerBaseTimer).
+/// @ingroup Latency
+template<class Trigger>
+    struct ScopedLatency
+    {
+        /// Constructor. The routine is entered.
+        INLINE explicit ScopedLatency(LatencyHistogram& histogram)
+#ifdef ENABLE_LATENCY_MONITOR
+                :
+                histogram(histogram), latency(Trigger::elapsed()), start(CycleCounter::now())
+#endif
+        {
+#ifndef ENABLE_LATENCY_MONITOR
+            (void) histogram;
+#endif
+        }
+
+        /// Destructor. The times are recorded.
+        INLINE ~ScopedLatency()
+        {
+#ifdef ENABLE_LATENCY_MONITOR
+            histogram.record(latency, CycleCounter::now() - start);
+#endif
+        }
+
+    private:
+#ifdef ENABLE_LATENCY_MONITOR
+        LatencyHistogram& histogram; ///< The histogram of the routine.
+        const uint32_t latency; ///< Cycles from the trigger to the entry.
+        const uint32_t start; ///< Value of the cycle counter at the entry.
+#endif
+
+        /// The object must not be copied. Otherwise the execution would be recorded twice.
+        ScopedLatency(const ScopedLatency&);
+
+        /// The object must not be copied. Otherwise the execution would be recorded twice.
+        ScopedLatency& operator=(const ScopedLatency&);
+    };
+
+#endif
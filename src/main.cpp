@@ -15,9 +15,36 @@
 #include "gpio.h"
 #include "isr.h"
 #include "utils.h"
+#include "benchmark.h"
+#include "defer.h"
+#include "event_loop.h"
+#include "kernel.h"
+#include "task.h"
+#include "timer_wheel.h"
 
-SysTickController sysTickCtrl; ///< The system tick controller object.
-GpioController gpioCtrl; ///< The gpio controller object.
+typedef GpioPin<DEBUG_PIN2> Debug2; ///< Static access object of debug pin 2
+typedef GpioPin<DEBUG_PIN3> Debug3; ///< Static access object of debug pin 3
+typedef GpioPin<LED_RED> LedRed; ///< Static access object of the red led
+
+/// Configuration of all used pins. It is applied once at startup.
+typedef GpioPinConfigTable<
+        GpioPinConfig<DEBUG_PIN1, GPIO_OUTPUT_LOW>,
+        GpioPinConfig<DEBUG_PIN2, GPIO_OUTPUT_LOW>,
+        GpioPinConfig<DEBUG_PIN3, GPIO_OUTPUT_LOW>,
+        GpioPinConfig<DEBUG_PIN4, GPIO_OUTPUT_LOW>,
+        GpioPinConfig<LED_RED, GPIO_OUTPUT_LOW> > PinConfig;
+
+/// @brief This template function drives a debug pin high while the cpu load is simulated.
+///
+/// @tparam DebugPin The static access object of the pin which is high during the load.
+template<class DebugPin>
+    STATIC_INLINE void simulateLoad()
+    {
+        DebugPin::setOutHigh();
+        // This prevents that veneers are included to call UTILS_burn when inlined into ramTrampoline()
+        UTILS_simulateLoad(1000000);
+        DebugPin::setOutLow();
+    }
 
 /// @brief Trampoline to code which is placed in ram.
 ///
@@ -25,12 +52,65 @@ GpioController gpioCtrl; ///< The gpio controller object.
 /// the generation of veneers for calling UTILS_simulateLoad(). Without
 /// veneers the execution time of UTILS_simulateLoad(...) can be measured
 /// more accurate.
-RAMFUNC void ramTrampoline(IGpioPin* debugPin)
+///
+/// @attention gcc ignores section attributes of function templates. Therefore this function
+/// is not a template. The static pin accesses are inlined into it.
+RAMFUNC void ramTrampoline()
+{
+    LedRed::setOutLow(); // red led on - inverse logic.
+    simulateLoad<Debug2>();
+    LedRed::setOutHigh(); // red led off - inverse logic.
+    simulateLoad<Debug3>();
+}
+
+/// This task prints a message once per second and simulates some load.
+struct HelloTask : public Task
+{
+    /// Implements Task::run()
+    TaskState run()
+    {
+        TASK_BEGIN();
+        deadline = SysTickController::ticks;
+        while (1)
+        {
+            deadline += 1000u;
+            TASK_AWAIT_TICK(deadline);
+
+            printf("Hello World %i, %i permille asleep\n", cycles, EVENT_getSleepPermille());
+            cycles++;
+
+            ramTrampoline();
+        }
+        TASK_END();
+    }
+
+    uint32_t deadline; ///< The tick of the next message.
+    uint32_t cycles; ///< Number of printed messages.
+};
+
+static HelloTask helloTask; ///< Prints a message once per second.
+
+/// Priority of the application thread.
+#define APPLICATION_PRIORITY 1
+
+static KernelThread applicationThread; ///< The thread which runs the application.
+static uint64_t applicationStack[256]; ///< The stack of the application thread. printf needs most of it.
+
+/// @brief The entry function of the application thread.
+///
+/// It runs the benchmarks and the event loop with the stackless tasks.
+static void runApplication(void*)
 {
-    debugPin->setOutHigh();
-    // This prevents that veneers are included to call UTILS_burn
-    UTILS_simulateLoad(1000000);
-    debugPin->setOutLow();
+#ifdef ENABLE_BENCHMARKS
+    BENCHMARK_run();
+#endif
+
+    TASK_init();
+    WHEEL_init();
+    TASK_start(helloTask);
+
+    // The core sleeps while no event is pending. The tasks run as handler of TASK_EVENT.
+    EVENT_run(FALSE);
 }
 
 /// @brief This function is the starting point of the program. 
@@ -41,47 +121,26 @@ RAMFUNC void ramTrampoline(IGpioPin* debugPin)
 /// @ingroup StartSequence
 int main()
 {
-    static uint32_t cycles;
-    IGpioPin* debug1; ///< Global reference to debug pin 1 object
-    IGpioPin* debug2; ///< Global reference to debug pin 2 object
-    IGpioPin* debug3; ///< Global reference to debug pin 3 object
-    IGpioPin* debug4; ///< Global reference to debug pin 4 object
+    // The systick vector calls SysTickController::tick() directly.
+    IsrBinding<&SysTickController::tick>::install(SysTick_IRQn);
 
-    ISR_registerSysTick(&sysTickCtrl);
+    // Interrupt service routines post their heavy processing to the PendSV routine.
+    DEFER_init();
 
     // printf: turn off buffers, so IO occurs immediately.
     setvbuf(stdin, NULL, _IONBF, 0);
     setvbuf(stdout, NULL, _IONBF, 0);
     setvbuf(stderr, NULL, _IONBF, 0);
 
-    // Initialize gpios.
-    debug1 = gpioCtrl.getPin<DEBUG_PIN1>();
-    debug2 = gpioCtrl.getPin<DEBUG_PIN2>();
-    debug3 = gpioCtrl.getPin<DEBUG_PIN3>();
-    debug4 = gpioCtrl.getPin<DEBUG_PIN4>();
-
-    IGpioPin* led_red = gpioCtrl.getPin<LED_RED>();
-
-    debug1->init(GPIO_OUTPUT_LOW);
-    debug2->init(GPIO_OUTPUT_LOW);
-    debug3->init(GPIO_OUTPUT_LOW);
-    debug4->init(GPIO_OUTPUT_LOW);
-
-    // Register debug1 Pin to be used as systick isr debug pin.
-    sysTickCtrl.registerDebugPin(debug1);
+    // Initialize gpios. DEBUG_PIN1 is used as systick isr debug pin (see SysTickProbe).
+    PinConfig::apply();
 
-    led_red->init(GPIO_OUTPUT_LOW);
+    // The application runs as kernel thread. The kernel replaces the PendSV routine of DEFER_init().
+    KERNEL_init();
+    KERNEL_createThread(applicationThread, &runApplication, NULL, applicationStack, sizeof(applicationStack),
+            APPLICATION_PRIORITY);
+    KERNEL_start();
 
-    while (1)
-    {
-        printf("Hello World %i\n", cycles);
-        cycles++;
-
-        led_red->setOutLow(); // red led on - inverse logic.
-        ramTrampoline(debug2);
-        led_red->setOutHigh(); // red led off - inverse logic.
-        ramTrampoline(debug3);
-    }
     // never leave this function
     return -1;
 }
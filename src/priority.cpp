@@ -0,0 +1,22 @@
+/// @file
+///
+/// @brief This file contains the implementation of the interrupt priority plan.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Priority
+
+#include <stdint.h>
+#include "mcu.h"
+#include "priority.h"
+
+void PRIORITY_init()
+{
+    NVIC_SetPriorityGrouping(PRIORITY_GROUPING);
+
+    // NMI and HardFault have fixed priorities. The priority bytes of the reserved
+    // exceptions are read as zero and ignore writes.
+    for (int32_t irq = MemManage_IRQn; irq < 128; irq++)
+    {
+        NVIC_SetPriority((IRQn_Type) irq, PRIORITY_get((IRQn_Type) irq));
+    }
+}
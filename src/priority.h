@@ -0,0 +1,268 @@
+/// @file
+///
+/// @brief This file contains the interrupt priority plan and the critical sections.
+///
+/// The priority of every exception and irq is defined once in PRIORITY_plan. PRIORITY_init() applies
+/// the plan at startup. All bits of the priority are preemption bits, there are no sub priorities.
+/// A lower value means a higher priority.
+///
+/// Data which is shared with an interrupt service routine is protected by a CriticalSection with the
+/// priority of that routine as ceiling. The critical section raises BASEPRI to the ceiling. Routines
+/// with a higher priority than the ceiling keep running:
+///
+/// @code
+/// static uint32_t count; // incremented by ISR_BaseTimer1()
+///
+/// uint32_t takeCount()
+/// {
+///     CriticalSection<PRIORITY_get(BT1_IRQn)> lock; // base timer 1 is masked until the end of the scope
+///     const uint32_t result = count;
+///     count = 0u;
+///     return result;
+/// }
+/// @endcode
+///
+/// Fault handlers and motor control routines can never be masked by a critical section.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Priority
+
+#ifndef __PRIORITY_H__
+#define __PRIORITY_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "utils.h"
+
+/// @brief This module contains the interrupt priorities and the critical sections.
+///
+/// @defgroup Priority Interrupt Priorities
+
+/// Value of the PRIGROUP field in AIRCR. All implemented priority bits are preemption bits.
+/// @ingroup Priority
+#define PRIORITY_GROUPING (7u - __NVIC_PRIO_BITS)
+
+/// This enum lists the priority levels of the system. A lower value means a higher priority.
+/// @ingroup Priority
+enum IrqPriority
+{
+    PRIORITY_FAULT = 0,         ///< Faults and clock, watchdog and voltage supervision
+    PRIORITY_MOTOR_CONTROL = 1, ///< Multi-function timers and quadrature decoders. The lowest priority which cannot be masked.
+    PRIORITY_MOTOR_SENSE = 2,   ///< Adc and ppg
+    PRIORITY_PWM = 3,           ///< Software pwm (base timer 1)
+    PRIORITY_TIMER = 4,         ///< Base timers and dual timer
+    PRIORITY_EXINT = 5,         ///< External interrupts. All EXINT irqs must have the same priority (see exint.h).
+    PRIORITY_DMA = 6,           ///< Dma and descriptor system data transfer controller
+    PRIORITY_COMMUNICATION = 7, ///< Serial interfaces, usb, can and sd card
+    PRIORITY_SYSTICK = 8,       ///< System tick
+    PRIORITY_DEFAULT = 12,      ///< All other irqs
+    PRIORITY_DEFERRED = 15      ///< Deferred work (PendSV, see defer.h). The lowest priority.
+};
+
+/// @brief The priority plan. Entry 16 + irq contains the priority of the irq or system exception.
+///
+/// The entries of the initial stack pointer, the reserved exceptions and the exceptions with a fixed
+/// priority are not applied.
+/// @ingroup Priority
+constexpr IrqPriority PRIORITY_plan[16 + 128] =
+{
+        PRIORITY_FAULT,          //  -16 initial stack pointer (no exception)
+        PRIORITY_FAULT,          //  -15 Reset (fixed)
+        PRIORITY_FAULT,          //  -14 NMI (fixed)
+        PRIORITY_FAULT,          //  -13 HardFault (fixed)
+        PRIORITY_FAULT,          //  -12 MemManage
+        PRIORITY_FAULT,          //  -11 BusFault
+        PRIORITY_FAULT,          //  -10 UsageFault
+        PRIORITY_DEFAULT,        //   -9 reserved
+        PRIORITY_DEFAULT,        //   -8 reserved
+        PRIORITY_DEFAULT,        //   -7 reserved
+        PRIORITY_DEFAULT,        //   -6 reserved
+        PRIORITY_DEFAULT,        //   -5 SVC
+        PRIORITY_DEFAULT,        //   -4 DebugMonitor
+        PRIORITY_DEFAULT,        //   -3 reserved
+        PRIORITY_DEFERRED,       //   -2 PendSV
+        PRIORITY_SYSTICK,        //   -1 SysTick
+        PRIORITY_FAULT,          //    0 CSV
+        PRIORITY_FAULT,          //    1 SWDT
+        PRIORITY_FAULT,          //    2 LVD
+        PRIORITY_DEFAULT,        //    3 IRQ003SEL
+        PRIORITY_DEFAULT,        //    4 IRQ004SEL
+        PRIORITY_DEFAULT,        //    5 IRQ005SEL
+        PRIORITY_DEFAULT,        //    6 IRQ006SEL
+        PRIORITY_DEFAULT,        //    7 IRQ007SEL
+        PRIORITY_DEFAULT,        //    8 IRQ008SEL
+        PRIORITY_DEFAULT,        //    9 IRQ009SEL
+        PRIORITY_DEFAULT,        //   10 IRQ010SEL
+        PRIORITY_EXINT,          //   11 EXINT0
+        PRIORITY_EXINT,          //   12 EXINT1
+        PRIORITY_EXINT,          //   13 EXINT2
+        PRIORITY_EXINT,          //   14 EXINT3
+        PRIORITY_EXINT,          //   15 EXINT4
+        PRIORITY_EXINT,          //   16 EXINT5
+        PRIORITY_EXINT,          //   17 EXINT6
+        PRIORITY_EXINT,          //   18 EXINT7
+        PRIORITY_MOTOR_CONTROL,  //   19 QPRC0
+        PRIORITY_MOTOR_CONTROL,  //   20 QPRC1
+        PRIORITY_MOTOR_CONTROL,  //   21 MFT0_WFG_DTIF
+        PRIORITY_MOTOR_CONTROL,  //   22 MFT1_WFG_DTIF
+        PRIORITY_DEFAULT,        //   23 reserved
+        PRIORITY_MOTOR_CONTROL,  //   24 MFT0_FRT_PEAK
+        PRIORITY_MOTOR_CONTROL,  //   25 MFT0_FRT_ZERO
+        PRIORITY_MOTOR_CONTROL,  //   26 MFT0_ICU
+        PRIORITY_MOTOR_CONTROL,  //   27 MFT0_OCU
+        PRIORITY_MOTOR_CONTROL,  //   28 MFT1_FRT_PEAK
+        PRIORITY_MOTOR_CONTROL,  //   29 MFT1_FRT_ZERO
+        PRIORITY_MOTOR_CONTROL,  //   30 MFT1_ICU
+        PRIORITY_MOTOR_CONTROL,  //   31 MFT1_OCU
+        PRIORITY_DEFAULT,        //   32 reserved
+        PRIORITY_DEFAULT,        //   33 reserved
+        PRIORITY_DEFAULT,        //   34 reserved
+        PRIORITY_DEFAULT,        //   35 reserved
+        PRIORITY_MOTOR_SENSE,    //   36 PPG00_02_04
+        PRIORITY_MOTOR_SENSE,    //   37 PPG08_10_12
+        PRIORITY_MOTOR_SENSE,    //   38 PPG16_18_20
+        PRIORITY_TIMER,          //   39 BT0
+        PRIORITY_PWM,            //   40 BT1
+        PRIORITY_TIMER,          //   41 BT2
+        PRIORITY_TIMER,          //   42 BT3
+        PRIORITY_TIMER,          //   43 BT4
+        PRIORITY_TIMER,          //   44 BT5
+        PRIORITY_TIMER,          //   45 BT6
+        PRIORITY_TIMER,          //   46 BT7
+        PRIORITY_TIMER,          //   47 DT
+        PRIORITY_DEFAULT,        //   48 WC
+        PRIORITY_COMMUNICATION,  //   49 EXTBUS_ERR
+        PRIORITY_DEFAULT,        //   50 RTC
+        PRIORITY_EXINT,          //   51 EXINT8
+        PRIORITY_EXINT,          //   52 EXINT9
+        PRIORITY_EXINT,          //   53 EXINT10
+        PRIORITY_EXINT,          //   54 EXINT11
+        PRIORITY_EXINT,          //   55 EXINT12
+        PRIORITY_EXINT,          //   56 EXINT13
+        PRIORITY_EXINT,          //   57 EXINT14
+        PRIORITY_EXINT,          //   58 EXINT15
+        PRIORITY_DEFAULT,        //   59 TIM
+        PRIORITY_COMMUNICATION,  //   60 MFS0_RX
+        PRIORITY_COMMUNICATION,  //   61 MFS0_TX
+        PRIORITY_COMMUNICATION,  //   62 MFS1_RX
+        PRIORITY_COMMUNICATION,  //   63 MFS1_TX
+        PRIORITY_COMMUNICATION,  //   64 MFS2_RX
+        PRIORITY_COMMUNICATION,  //   65 MFS2_TX
+        PRIORITY_COMMUNICATION,  //   66 MFS3_RX
+        PRIORITY_COMMUNICATION,  //   67 MFS3_TX
+        PRIORITY_COMMUNICATION,  //   68 MFS4_RX
+        PRIORITY_COMMUNICATION,  //   69 MFS4_TX
+        PRIORITY_COMMUNICATION,  //   70 MFS5_RX
+        PRIORITY_COMMUNICATION,  //   71 MFS5_TX
+        PRIORITY_COMMUNICATION,  //   72 MFS6_RX
+        PRIORITY_COMMUNICATION,  //   73 MFS6_TX
+        PRIORITY_COMMUNICATION,  //   74 MFS7_RX
+        PRIORITY_COMMUNICATION,  //   75 MFS7_TX
+        PRIORITY_MOTOR_SENSE,    //   76 ADC0
+        PRIORITY_MOTOR_SENSE,    //   77 ADC1
+        PRIORITY_COMMUNICATION,  //   78 USB0_F
+        PRIORITY_COMMUNICATION,  //   79 USB0_H_F
+        PRIORITY_COMMUNICATION,  //   80 CAN0
+        PRIORITY_COMMUNICATION,  //   81 CAN1
+        PRIORITY_DEFAULT,        //   82 reserved
+        PRIORITY_DMA,            //   83 DMAC0
+        PRIORITY_DMA,            //   84 DMAC1
+        PRIORITY_DMA,            //   85 DMAC2
+        PRIORITY_DMA,            //   86 DMAC3
+        PRIORITY_DMA,            //   87 DMAC4
+        PRIORITY_DMA,            //   88 DMAC5
+        PRIORITY_DMA,            //   89 DMAC6
+        PRIORITY_DMA,            //   90 DMAC7
+        PRIORITY_DMA,            //   91 DSTC
+        PRIORITY_EXINT,          //   92 EXINT16_19
+        PRIORITY_EXINT,          //   93 EXINT20_23
+        PRIORITY_EXINT,          //   94 EXINT24_27
+        PRIORITY_EXINT,          //   95 EXINT28_31
+        PRIORITY_DEFAULT,        //   96 reserved
+        PRIORITY_DEFAULT,        //   97 reserved
+        PRIORITY_DEFAULT,        //   98 reserved
+        PRIORITY_DEFAULT,        //   99 reserved
+        PRIORITY_DEFAULT,        //  100 reserved
+        PRIORITY_DEFAULT,        //  101 reserved
+        PRIORITY_DEFAULT,        //  102 reserved
+        PRIORITY_DEFAULT,        //  103 reserved
+        PRIORITY_DEFAULT,        //  104 reserved
+        PRIORITY_DEFAULT,        //  105 reserved
+        PRIORITY_DEFAULT,        //  106 reserved
+        PRIORITY_DEFAULT,        //  107 reserved
+        PRIORITY_DEFAULT,        //  108 reserved
+        PRIORITY_DEFAULT,        //  109 reserved
+        PRIORITY_DEFAULT,        //  110 reserved
+        PRIORITY_MOTOR_SENSE,    //  111 ADC2
+        PRIORITY_DMA,            //  112 DSTC_HW
+        PRIORITY_DEFAULT,        //  113 reserved
+        PRIORITY_DEFAULT,        //  114 reserved
+        PRIORITY_DEFAULT,        //  115 reserved
+        PRIORITY_DEFAULT,        //  116 reserved
+        PRIORITY_DEFAULT,        //  117 reserved
+        PRIORITY_COMMUNICATION,  //  118 SD
+        PRIORITY_DEFAULT,        //  119 FLASHIF
+        PRIORITY_DEFAULT,        //  120 reserved
+        PRIORITY_DEFAULT,        //  121 reserved
+        PRIORITY_DEFAULT,        //  122 reserved
+        PRIORITY_DEFAULT,        //  123 reserved
+        PRIORITY_DEFAULT,        //  124 reserved
+        PRIORITY_DEFAULT,        //  125 reserved
+        PRIORITY_DEFAULT,        //  126 reserved
+        PRIORITY_DEFAULT         //  127 reserved
+};
+
+/// @brief This function returns the planned priority of an irq.
+///
+/// @param irq The irq or system exception.
+/// @returns The priority.
+/// @ingroup Priority
+constexpr IrqPriority PRIORITY_get(const IRQn_Type irq)
+{
+    return PRIORITY_plan[16 + irq];
+}
+
+/// @brief This function sets the priority grouping and applies the priority plan.
+///
+/// It is called by ISR_Reset() after the systick was configured.
+/// @ingroup Priority
+void PRIORITY_init();
+
+/// @brief This template class is a critical section which masks all irqs up to a ceiling priority.
+///
+/// BASEPRI is raised to the ceiling when the object is constructed and restored when it goes out of
+/// scope. Critical sections can be nested. A critical section never lowers the actual masking, e.g.
+/// when it is entered by a routine with a higher priority than the ceiling.
+///
+/// @tparam ceiling The highest priority of the routines which share the protected data.
+/// @ingroup Priority
+template<IrqPriority ceiling>
+    struct CriticalSection
+    {
+        static_assert(ceiling > PRIORITY_MOTOR_CONTROL, "Fault handlers and motor control routines must never be masked");
+        static_assert(ceiling < (1u << __NVIC_PRIO_BITS), "The ceiling exceeds the implemented priority bits");
+
+        /// Constructor. The critical section is entered.
+        INLINE CriticalSection() :
+                previous(__get_BASEPRI())
+        {
+            __set_BASEPRI_MAX(ceiling << (8u - __NVIC_PRIO_BITS));
+        }
+
+        /// Destructor. The critical section is left.
+        INLINE ~CriticalSection()
+        {
+            __set_BASEPRI(previous);
+        }
+
+    private:
+        const uint32_t previous; ///< BASEPRI before the critical section was entered.
+
+        /// The critical section must not be copied. Otherwise BASEPRI would be restored twice.
+        CriticalSection(const CriticalSection&);
+
+        /// The critical section must not be copied. Otherwise BASEPRI would be restored twice.
+        CriticalSection& operator=(const CriticalSection&);
+    };
+
+#endif
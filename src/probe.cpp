@@ -0,0 +1,47 @@
+/// @file
+///
+/// @brief This file contains the implementation of the timing probe trace buffer.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Probe
+
+#include <stdio.h>
+#include <stdint.h>
+#include "base_types.h"
+#include "probe.h"
+
+ProbeRecord PROBE_traceBuffer[PROBE_TRACE_SIZE];
+volatile uint32_t PROBE_traceCount;
+
+void PROBE_dumpTrace()
+{
+    const uint32_t end = PROBE_traceCount;
+    const uint32_t begin = (end > PROBE_TRACE_SIZE) ? end - PROBE_TRACE_SIZE : 0u;
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        const ProbeRecord& record = PROBE_traceBuffer[i & (PROBE_TRACE_SIZE - 1u)];
+        if (record.enter)
+        {
+            printf("probe %u enter at %lu\n", (unsigned) record.id, (unsigned long) record.timestamp);
+            continue;
+        }
+
+        // Search the matching enter record to calculate the duration of the scope.
+        boolean_t found = FALSE;
+        for (uint32_t j = i; j > begin && !found; j--)
+        {
+            const ProbeRecord& entered = PROBE_traceBuffer[(j - 1u) & (PROBE_TRACE_SIZE - 1u)];
+            if (entered.enter && entered.id == record.id)
+            {
+                printf("probe %u leave at %lu, %lu cycles\n", (unsigned) record.id,
+                        (unsigned long) record.timestamp, (unsigned long) (record.timestamp - entered.timestamp));
+                found = TRUE;
+            }
+        }
+        if (!found)
+        {
+            printf("probe %u leave at %lu\n", (unsigned) record.id, (unsigned long) record.timestamp);
+        }
+    }
+}
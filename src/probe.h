@@ -0,0 +1,193 @@
+/// @file
+///
+/// @brief This file contains the timing probes.
+///
+/// A timing probe marks the execution time of a scope. A ScopedProbe object calls enter() of its
+/// sink when it is constructed and leave() when it goes out of scope:
+///
+/// @code
+/// typedef ProbePin<DEBUG_PIN2> LoadProbe;
+///
+/// void load()
+/// {
+///     ScopedProbe<LoadProbe> probe; // DEBUG_PIN2 is high until load() returns
+///     ...
+/// }
+/// @endcode
+///
+/// The sink is resolved at compile time. There are two sinks:
+///
+/// * ProbePin - drives a debug pin high while the scope is executed. Each edge is a single bit-band store.
+/// * ProbeTrace - writes a timestamped record into the trace buffer on entry and exit.
+///
+/// The probes are only active when the macro ENABLE_PROBES is defined (see Makefile). Otherwise all
+/// probes compile to nothing, so they can stay in production code.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Probe
+
+#ifndef __PROBE_H__
+#define __PROBE_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "cycle_counter.h"
+#include "gpio.h"
+#include "utils.h"
+
+/// @brief This module contains the timing probes.
+///
+/// @defgroup Probe Timing Probes
+
+/// Number of records the trace buffer can hold. Must be a power of two.
+/// @ingroup Probe
+#define PROBE_TRACE_SIZE 64
+
+/// This struct describes a single record of the trace buffer.
+/// @ingroup Probe
+struct ProbeRecord
+{
+    uint32_t timestamp; ///< Value of the cycle counter when the record was written.
+    uint8_t id; ///< The identifier of the probe.
+    boolean_t enter; ///< TRUE when the scope was entered, FALSE when it was left.
+};
+
+/// The trace buffer. It is written by ProbeTrace and read by PROBE_dumpTrace().
+/// @ingroup Probe
+extern ProbeRecord PROBE_traceBuffer[PROBE_TRACE_SIZE];
+
+/// Number of records written to the trace buffer. Only the last PROBE_TRACE_SIZE records are kept.
+/// @ingroup Probe
+extern volatile uint32_t PROBE_traceCount;
+
+/// @brief This function writes the records of the trace buffer to stdout, the oldest record first.
+///
+/// The durations of the scopes are calculated from the enter and leave records of each probe.
+/// @ingroup Probe
+void PROBE_dumpTrace();
+
+/// @brief This template class is a probe sink which drives a gpio pin.
+///
+/// The pin is high while the scope is executed. It must be initialized as output low.
+///
+/// @tparam pinId The pin identifier.
+/// @ingroup Probe
+template<GpioPinId pinId>
+    struct ProbePin
+    {
+        /// Drives the pin high.
+        STATIC_INLINE void enter()
+        {
+#ifdef ENABLE_PROBES
+            GpioHal::setOut<pinId>(TRUE);
+#endif
+        }
+
+        /// Drives the pin low.
+        STATIC_INLINE void leave()
+        {
+#ifdef ENABLE_PROBES
+            GpioHal::setOut<pinId>(FALSE);
+#endif
+        }
+
+    private:
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        ProbePin();
+    };
+
+/// @brief This template class is a probe sink which writes into the trace buffer.
+///
+/// The slot of a record is claimed with ldrex/strex. Probes can be used in thread mode and in
+/// interrupt service routines of any priority.
+///
+/// @tparam id The identifier of the probe which is written into the records.
+/// @ingroup Probe
+template<uint8_t id>
+    struct ProbeTrace
+    {
+        /// Writes an enter record.
+        STATIC_INLINE void enter()
+        {
+#ifdef ENABLE_PROBES
+            write(TRUE);
+#endif
+        }
+
+        /// Writes a leave record.
+        STATIC_INLINE void leave()
+        {
+#ifdef ENABLE_PROBES
+            write(FALSE);
+#endif
+        }
+
+    private:
+        /// Claims the next slot of the trace buffer and writes a record into it.
+        STATIC_INLINE void write(const boolean_t enter)
+        {
+            const uint32_t timestamp = CycleCounter::now();
+            uint32_t slot;
+            do
+            {
+                slot = __LDREXW(&PROBE_traceCount);
+            } while (__STREXW(slot + 1u, &PROBE_traceCount) != 0u);
+
+            ProbeRecord& record = PROBE_traceBuffer[slot & (PROBE_TRACE_SIZE - 1u)];
+            record.timestamp = timestamp;
+            record.id = id;
+            record.enter = enter;
+        }
+
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        ProbeTrace();
+    };
+
+/// This class is a probe sink which does nothing. It can be used to disable a single probe.
+/// @ingroup Probe
+struct ProbeNone
+{
+    /// Does nothing.
+    STATIC_INLINE void enter()
+    {
+    }
+
+    /// Does nothing.
+    STATIC_INLINE void leave()
+    {
+    }
+
+private:
+    /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+    ProbeNone();
+};
+
+/// @brief This template class marks the execution time of a scope.
+///
+/// @tparam Sink The probe sink (ProbePin, ProbeTrace or ProbeNone).
+/// @ingroup Probe
+template<class Sink>
+    struct ScopedProbe
+    {
+        /// Constructor. The scope is entered.
+        INLINE ScopedProbe()
+        {
+            Sink::enter();
+        }
+
+        /// Destructor. The scope is left.
+        INLINE ~ScopedProbe()
+        {
+            Sink::leave();
+        }
+
+    private:
+        /// The probe must not be copied. Otherwise the scope would be left twice.
+        ScopedProbe(const ScopedProbe&);
+
+        /// The probe must not be copied. Otherwise the scope would be left twice.
+        ScopedProbe& operator=(const ScopedProbe&);
+    };
+
+#endif
@@ -0,0 +1,175 @@
+/// @file
+///
+/// @brief This file contains the implementation of the software pwm module.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Pwm
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "pwm.h"
+#include "latency.h"
+#include "utils.h"
+
+/// Number of gpio ports
+#define PWM_PORTS 16
+
+/// Base timer TMCR: reload timer mode (FMD = 011)
+static const uint16_t BT_TMCR_RELOAD_TIMER = 0x3u << 4;
+/// Base timer TMCR: count enable
+static const uint16_t BT_TMCR_CTEN = 1u << 1;
+/// Base timer TMCR: software start trigger
+static const uint16_t BT_TMCR_STRG = 1u << 0;
+/// Base timer STC: underflow interrupt request enable
+static const uint8_t BT_STC_UDIE = 1u << 4;
+/// Base timer STC: underflow interrupt request
+static const uint8_t BT_STC_UDIR = 1u << 0;
+
+static uint16_t planes[PWM_RESOLUTION][PWM_PORTS]; ///< Output levels of the pwm pins of each port during each slot.
+static uint16_t portMasks[PWM_PORTS]; ///< The pwm pins of each port.
+static uint8_t usedPorts[PWM_CHANNELS]; ///< The ports which contain at least one pwm pin.
+static uint8_t usedPortCount; ///< Number of entries in usedPorts.
+
+static GpioPinId pins[PWM_CHANNELS]; ///< The pin of each channel.
+static uint16_t activeLows; ///< Bit x is set when channel x is active low.
+static uint16_t assignedChannels; ///< Bit x is set when a pin is assigned to channel x.
+
+static uint32_t slotUnit; ///< Length of the slot unit in timer cycles.
+static uint32_t slot; ///< The slot which is output next.
+
+static LatencyHistogram latency(BT1_IRQn); ///< Latency and execution time of the interrupt service routine.
+
+/// Returns the port of a pin.
+static INLINE uint8_t getPort(const GpioPinId pin)
+{
+    return (uint8_t) (pin >> 4);
+}
+
+/// Returns the bit of a pin in the port registers.
+static INLINE uint16_t getMask(const GpioPinId pin)
+{
+    return (uint16_t) (1u << (pin & 0xFu));
+}
+
+/// Returns the PDOR register of a port.
+static INLINE volatile uint32_t& getPdor(const uint8_t port)
+{
+    return *((volatile uint32_t*) (FM4_GPIO_BASE + GPIO_HAL_PDOR_OFFSET + 4u * port));
+}
+
+/// @brief Writes the plane of the next slot to the ports and programs the length of the following slot.
+///
+/// The reload timer loads the new length at the end of the actual slot.
+static INLINE void outputSlot()
+{
+    const uint16_t* plane = planes[slot];
+    for (uint32_t i = 0; i < usedPortCount; i++)
+    {
+        const uint8_t port = usedPorts[i];
+        volatile uint32_t& pdor = getPdor(port);
+        pdor = (pdor & ~(uint32_t) portMasks[port]) | plane[port];
+    }
+
+    slot = (slot + 1u) % PWM_RESOLUTION;
+    FM4_BT1_RT->PCSR = (slotUnit << slot) - 1u;
+}
+
+void PWM_setChannel(const uint8_t channel, const GpioPinId pin, const boolean_t activeLow)
+{
+    PWM_setDuty(channel, 0u);
+    pins[channel] = pin;
+    assignedChannels |= 1u << channel;
+    if (activeLow)
+    {
+        activeLows |= 1u << channel;
+    }
+    else
+    {
+        activeLows &= ~(1u << channel);
+    }
+    PWM_setDuty(channel, 0u);
+
+    // Rebuild the port masks of all channels. A pin of a reassigned channel is no longer driven.
+    usedPortCount = 0u;
+    for (uint8_t port = 0; port < PWM_PORTS; port++)
+    {
+        portMasks[port] = 0u;
+    }
+    for (uint8_t i = 0; i < PWM_CHANNELS; i++)
+    {
+        if ((assignedChannels & (1u << i)) != 0u)
+        {
+            const uint8_t port = getPort(pins[i]);
+            if (portMasks[port] == 0u)
+            {
+                usedPorts[usedPortCount++] = port;
+            }
+            portMasks[port] |= getMask(pins[i]);
+        }
+    }
+}
+
+void PWM_setDuty(const uint8_t channel, const uint8_t duty)
+{
+    if ((assignedChannels & (1u << channel)) == 0u)
+    {
+        return;
+    }
+
+    const uint8_t port = getPort(pins[channel]);
+    const uint16_t mask = getMask(pins[channel]);
+    const uint32_t levels = ((activeLows & (1u << channel)) != 0u) ? ~(uint32_t) duty : duty;
+
+    for (uint32_t bit = 0; bit < PWM_RESOLUTION; bit++)
+    {
+        if ((levels & (1u << bit)) != 0u)
+        {
+            planes[bit][port] |= mask;
+        }
+        else
+        {
+            planes[bit][port] &= ~mask;
+        }
+    }
+}
+
+void PWM_start(const uint32_t slotCycles)
+{
+    PWM_stop();
+
+    slotUnit = slotCycles;
+    slot = 0u;
+
+    // The mode must be selected before the other timer registers are written.
+    FM4_BT1_RT->TMCR = BT_TMCR_RELOAD_TIMER;
+    FM4_BT1_RT->PCSR = slotUnit - 1u;
+    FM4_BT1_RT->STC = BT_STC_UDIE;
+
+    NVIC_ClearPendingIRQ(BT1_IRQn);
+    NVIC_EnableIRQ(BT1_IRQn);
+
+    FM4_BT1_RT->TMCR = BT_TMCR_RELOAD_TIMER | BT_TMCR_CTEN;
+    FM4_BT1_RT->TMCR = BT_TMCR_RELOAD_TIMER | BT_TMCR_CTEN | BT_TMCR_STRG;
+    outputSlot();
+}
+
+void PWM_stop()
+{
+    FM4_BT1_RT->TMCR = BT_TMCR_RELOAD_TIMER;
+    FM4_BT1_RT->STC = 0u;
+    NVIC_DisableIRQ(BT1_IRQn);
+}
+
+/// @brief Base timer 1 interrupt service routine
+///
+/// It is raised at the start of each slot.
+///
+/// @attention C Linkage is required for all interrupt service routines.
+extern "C" void ISR_BaseTimer1()
+{
+    // PCSR still holds the length of the actual slot. It is changed by outputSlot().
+    ScopedLatency<LatencyTriggerBaseTimer<FM4_BT1_RT_BASE> > monitor(latency);
+    FM4_BT1_RT->STC &= ~BT_STC_UDIR;
+    outputSlot();
+}
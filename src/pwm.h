@@ -0,0 +1,80 @@
+/// @file
+///
+/// @brief This file contains the software pwm module.
+///
+/// The software pwm uses bit angle modulation (BAM). A frame consists out of one time slot per bit of
+/// the duty cycle. The slot of bit b lasts 2^b slot units. During the slot of bit b each channel
+/// outputs bit b of its duty cycle. The average output level equals duty / (2^PWM_RESOLUTION - 1).
+///
+/// The output levels of each slot are precomputed as masks per port ("bit planes"). The interrupt
+/// service routine of base timer 1 is raised at the start of each slot. It writes the plane of the
+/// slot with one access per used port and programs the length of the next slot. A frame needs only
+/// PWM_RESOLUTION interrupts, independent of the number of channels.
+///
+/// @attention The port outputs are changed with read-modify-write accesses. No isr with a higher
+/// priority must change pins of a port which is used by the pwm.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Pwm
+
+#ifndef __PWM_H__
+#define __PWM_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "gpio.h"
+
+/// @brief This module contains the software pwm.
+///
+/// @defgroup Pwm Software PWM
+
+/// Number of pwm channels.
+/// @ingroup Pwm
+#define PWM_CHANNELS 16
+
+/// Number of bits of the duty cycle. It equals the number of slots per frame.
+/// @ingroup Pwm
+#define PWM_RESOLUTION 8
+
+/// Maximum length of the slot unit in timer cycles. The longest slot must fit into the 16 bit timer.
+/// @ingroup Pwm
+#define PWM_MAX_SLOT_CYCLES (0x10000u >> (PWM_RESOLUTION - 1))
+
+/// @brief This function assigns a pin to a pwm channel.
+///
+/// The duty cycle of the channel is set to 0. A pin which was previously assigned to the channel
+/// keeps its last output level. The channels should be assigned before PWM_start() is called.
+///
+/// @attention The pin must be initialized as output.
+///
+/// @param channel The channel (0 - PWM_CHANNELS - 1).
+/// @param pin The pin which is driven by the channel.
+/// @param activeLow TRUE when the load is on while the pin is low (e.g. the leds of the board).
+/// @ingroup Pwm
+void PWM_setChannel(const uint8_t channel, const GpioPinId pin, const boolean_t activeLow);
+
+/// @brief This function sets the duty cycle of a channel.
+///
+/// The bit planes are changed in place. During the frame in which the duty cycle is changed the
+/// channel can output a mix of the old and the new duty cycle.
+///
+/// @param channel The channel (0 - PWM_CHANNELS - 1).
+/// @param duty The duty cycle. 0 is always off, 2^PWM_RESOLUTION - 1 is always on.
+/// @ingroup Pwm
+void PWM_setDuty(const uint8_t channel, const uint8_t duty);
+
+/// @brief This function starts the software pwm.
+///
+/// The frame length is (2^PWM_RESOLUTION - 1) * slotCycles timer cycles. The shortest slot must be
+/// longer than the execution time of the interrupt service routine.
+///
+/// @param slotCycles The length of the slot unit in cycles of the base timer clock (1 - PWM_MAX_SLOT_CYCLES).
+/// @ingroup Pwm
+void PWM_start(const uint32_t slotCycles);
+
+/// @brief This function stops the software pwm. The pins keep their last output level.
+/// @ingroup Pwm
+void PWM_stop();
+
+#endif
@@ -0,0 +1,376 @@
+/// @file
+///
+/// @brief This file contains lock free ring buffers.
+///
+/// The ring buffers move data between interrupt service routines and thread mode without disabling
+/// interrupts and without dynamic memory. Both variants have a capacity which is a power of two. The
+/// read and write indices run freely and are masked when a slot is accessed. Only the indices are
+/// shared between producers and consumer, the elements are accessed without synchronization.
+///
+/// * SpscRingBuffer - one producer and one consumer. Each index is written by one side only.
+/// * MpscRingBuffer - producers of different priorities and one consumer. The slots are claimed
+///   with ldrex/strex.
+///
+/// Besides single elements, contiguous spans can be written and read in place. A span ends at the end
+/// of the storage, it never wraps around. This allows e.g. a dma channel to write directly into the
+/// buffer. A claim of the MPSC variant which does not fit in front of the end of the storage skips the
+/// remaining slots, see MpscRingBuffer::reserve():
+///
+/// @code
+/// SpscRingBuffer<uint16_t, 256> samples;
+///
+/// uint16_t* span;
+/// const uint32_t free = samples.getWriteSpan(span);
+/// ... // let the dma write up to free samples to span, then
+/// samples.commitWrite(written);
+/// @endcode
+///
+/// @attention The ring buffers are made for a single core. The MPSC variant relies on the fact that
+/// a producer which preempts another producer finishes before the preempted one continues.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup RingBuffer
+
+#ifndef __RING_BUFFER_H__
+#define __RING_BUFFER_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "utils.h"
+
+/// @brief This module contains the lock free ring buffers.
+///
+/// @defgroup RingBuffer Ring Buffers
+
+/// @brief This template class contains the consumer side which is common to both ring buffers.
+///
+/// The element at index i is valid while tail <= i < head.
+///
+/// @tparam T The type of the elements.
+/// @tparam capacity The number of elements. Must be a power of two.
+/// @ingroup RingBuffer
+template<class T, uint32_t capacity>
+    struct RingBufferBase
+    {
+        static_assert(capacity != 0u && (capacity & (capacity - 1u)) == 0u, "The capacity must be a power of two");
+
+        /// Returns the number of elements which can be read.
+        INLINE uint32_t getCount() const
+        {
+            return head - tail;
+        }
+
+        /// Returns TRUE when no element can be read.
+        INLINE boolean_t isEmpty() const
+        {
+            return head == tail;
+        }
+
+        /// @brief Reads the oldest element. Must only be called by the consumer.
+        ///
+        /// @param value The element is written to this reference.
+        /// @returns TRUE when an element was read, FALSE when the buffer is empty.
+        INLINE boolean_t pop(T& value)
+        {
+            const uint32_t index = tail;
+            if (head == index)
+            {
+                return FALSE;
+            }
+            __DMB(); // the element must not be read before head
+            value = storage[index & (capacity - 1u)];
+            __DMB(); // the element must be read before the slot is released
+            tail = index + 1u;
+            return TRUE;
+        }
+
+        /// @brief Returns the oldest elements which are contiguous in memory. Must only be called by the consumer.
+        ///
+        /// The elements stay in the buffer until they are released with commitRead().
+        ///
+        /// @param span The address of the oldest element is written to this reference.
+        /// @returns The number of contiguous elements, 0 when the buffer is empty.
+        INLINE uint32_t getReadSpan(const T*& span)
+        {
+            const uint32_t index = tail;
+            const uint32_t available = head - index;
+            const uint32_t offset = index & (capacity - 1u);
+            __DMB(); // the elements must not be read before head
+            span = &storage[offset];
+            return (available < capacity - offset) ? available : capacity - offset;
+        }
+
+        /// @brief Releases the oldest elements. Must only be called by the consumer.
+        ///
+        /// @param count The number of elements. It must not exceed the last result of getReadSpan().
+        INLINE void commitRead(const uint32_t count)
+        {
+            __DMB(); // the elements must be read before the slots are released
+            tail = tail + count;
+        }
+
+    protected:
+        /// Constructor. The buffer is empty.
+        RingBufferBase() :
+                head(0u), tail(0u)
+        {
+        }
+
+        T storage[capacity]; ///< The elements.
+        volatile uint32_t head; ///< Index of the next element which is written. Written by the producers.
+        volatile uint32_t tail; ///< Index of the next element which is read. Written by the consumer.
+
+    private:
+        /// The buffer must not be copied.
+        RingBufferBase(const RingBufferBase&);
+
+        /// The buffer must not be copied.
+        RingBufferBase& operator=(const RingBufferBase&);
+    };
+
+/// @brief This template class is a ring buffer with a single producer and a single consumer.
+///
+/// The producer and the consumer may run at different priorities.
+///
+/// @tparam T The type of the elements.
+/// @tparam capacity The number of elements. Must be a power of two.
+/// @ingroup RingBuffer
+template<class T, uint32_t capacity>
+    struct SpscRingBuffer : public RingBufferBase<T, capacity>
+    {
+        /// @brief Writes an element. Must only be called by the producer.
+        ///
+        /// @param value The element.
+        /// @returns TRUE when the element was written, FALSE when the buffer is full.
+        INLINE boolean_t push(const T& value)
+        {
+            const uint32_t index = this->head;
+            if (index - this->tail >= capacity)
+            {
+                return FALSE;
+            }
+            __DMB(); // the slot must not be written before it was released
+            this->storage[index & (capacity - 1u)] = value;
+            __DMB(); // the element must be written before it is published
+            this->head = index + 1u;
+            return TRUE;
+        }
+
+        /// @brief Returns the free slots which are contiguous in memory. Must only be called by the producer.
+        ///
+        /// The slots can be written in place, e.g. by a dma channel. They are published with commitWrite().
+        ///
+        /// @param span The address of the first free slot is written to this reference.
+        /// @returns The number of contiguous free slots, 0 when the buffer is full.
+        INLINE uint32_t getWriteSpan(T*& span)
+        {
+            const uint32_t index = this->head;
+            const uint32_t available = capacity - (index - this->tail);
+            const uint32_t offset = index & (capacity - 1u);
+            __DMB(); // the slots must not be written before they were released
+            span = &this->storage[offset];
+            return (available < capacity - offset) ? available : capacity - offset;
+        }
+
+        /// @brief Publishes written slots. Must only be called by the producer.
+        ///
+        /// @param count The number of slots. It must not exceed the last result of getWriteSpan().
+        INLINE void commitWrite(const uint32_t count)
+        {
+            __DMB(); // the elements must be written before they are published
+            this->head = this->head + count;
+        }
+    };
+
+/// @brief This template class is a ring buffer with multiple producers and a single consumer.
+///
+/// A producer claims slots by advancing the reserved index with ldrex/strex and writes them. Slots
+/// are published when the last active producer commits: at that moment all producers which
+/// preempted it have completed their slots. A claim always fails when the buffer is full, a
+/// producer never waits for another one.
+///
+/// The claimed slots are contiguous. A claim which does not fit in front of the end of the storage
+/// also claims the slots up to the end as padding and starts at the beginning of the storage. The
+/// consumer skips the padding. Only one padding can lie between tail and reserved: a claim passes the
+/// end of the storage only when the consumer has released the slots up to the previous end.
+///
+/// @tparam T The type of the elements.
+/// @tparam capacity The number of elements. Must be a power of two.
+/// @ingroup RingBuffer
+template<class T, uint32_t capacity>
+    struct MpscRingBuffer : public RingBufferBase<T, capacity>
+    {
+        /// Constructor. The buffer is empty.
+        MpscRingBuffer() :
+                reserved(0u), writers(0u), padding(0u)
+        {
+        }
+
+        /// Returns the number of elements which can be read. Padding is not counted.
+        INLINE uint32_t getCount() const
+        {
+            const uint32_t index = this->tail;
+            const uint32_t count = this->head - index;
+            __DMB(); // the padding must not be read before head
+            const uint32_t start = padding;
+            return (start - index < count) ? count - getPaddingSize(start) : count;
+        }
+
+        /// @brief Reads the oldest element. Must only be called by the consumer.
+        ///
+        /// @param value The element is written to this reference.
+        /// @returns TRUE when an element was read, FALSE when the buffer is empty.
+        INLINE boolean_t pop(T& value)
+        {
+            uint32_t index = this->tail;
+            if (this->head == index)
+            {
+                return FALSE;
+            }
+            __DMB(); // the element and the padding must not be read before head
+            if (index == padding)
+            {
+                index += getPaddingSize(index); // the padding is published with the slots behind it
+            }
+            value = this->storage[index & (capacity - 1u)];
+            __DMB(); // the element must be read before the slot is released
+            this->tail = index + 1u;
+            return TRUE;
+        }
+
+        /// @brief Returns the oldest elements which are contiguous in memory. Must only be called by the consumer.
+        ///
+        /// The elements stay in the buffer until they are released with commitRead(). A padding in front
+        /// of them is released at once.
+        ///
+        /// @param span The address of the oldest element is written to this reference.
+        /// @returns The number of contiguous elements, 0 when the buffer is empty.
+        INLINE uint32_t getReadSpan(const T*& span)
+        {
+            uint32_t index = this->tail;
+            uint32_t available = this->head - index;
+            __DMB(); // the elements and the padding must not be read before head
+            const uint32_t start = padding;
+            if (available != 0u && index == start)
+            {
+                const uint32_t size = getPaddingSize(index);
+                index += size;
+                available -= size;
+                this->tail = index;
+            }
+
+            const uint32_t offset = index & (capacity - 1u);
+            span = &this->storage[offset];
+            uint32_t contiguous = (available < capacity - offset) ? available : capacity - offset;
+            if (start != index && start - index < contiguous)
+            {
+                contiguous = start - index; // the elements end at the next padding
+            }
+            return contiguous;
+        }
+
+        /// @brief Writes an element. Can be called by any producer.
+        ///
+        /// @param value The element.
+        /// @returns TRUE when the element was written, FALSE when the buffer is full.
+        INLINE boolean_t push(const T& value)
+        {
+            T* slot = reserve(1u);
+            if (slot == NULL)
+            {
+                return FALSE;
+            }
+            *slot = value;
+            commit();
+            return TRUE;
+        }
+
+        /// @brief Claims free slots which are contiguous in memory. Can be called by any producer.
+        ///
+        /// The slots can be written in place. commit() must be called after they were written. When
+        /// the slots do not fit in front of the end of the storage, the slots up to the end are
+        /// claimed as padding and the claimed slots start at the beginning of the storage. With the
+        /// padding a claim needs up to 2 * count - 1 free slots, so a claim of more than half of the
+        /// capacity could never succeed. It is rejected.
+        ///
+        /// @param count The number of slots (1 - capacity / 2).
+        /// @returns The address of the first slot or NULL when there are not enough free slots.
+        INLINE T* reserve(const uint32_t count)
+        {
+            add(writers, 1u);
+
+            uint32_t index;
+            uint32_t size;
+            do
+            {
+                index = __LDREXW(&reserved);
+                const uint32_t offset = index & (capacity - 1u);
+                size = (capacity - offset < count) ? capacity - offset : 0u;
+                if (count > capacity / 2u || capacity - (index - this->tail) < size + count)
+                {
+                    __CLREX();
+                    commit(); // nothing is claimed, but the slots of preempted producers may be published
+                    return NULL;
+                }
+            } while (__STREXW(index + size + count, &reserved) != 0u);
+
+            if (size != 0u)
+            {
+                // The padding is published with the claimed slots, when all producers have committed.
+                padding = index;
+            }
+            __DMB(); // the slots must not be written before they were released
+            return &this->storage[(index + size) & (capacity - 1u)];
+        }
+
+        /// @brief Publishes the slots of the last reserve(). Can be called by any producer.
+        ///
+        /// The slots become visible to the consumer when no other producer is writing.
+        INLINE void commit()
+        {
+            __DMB(); // the elements must be written before they are published
+            if (add(writers, (uint32_t) -1) != 0u)
+            {
+                return; // the preempted producer publishes the slots when it commits
+            }
+
+            // All claimed slots are written. Producers which preempt this one complete their slots
+            // before it continues. The head only moves forward, a stale value is ignored.
+            const uint32_t published = reserved;
+            uint32_t index;
+            do
+            {
+                index = __LDREXW(&this->head);
+                if ((int32_t) (published - index) <= 0)
+                {
+                    __CLREX();
+                    return;
+                }
+            } while (__STREXW(published, &this->head) != 0u);
+        }
+
+    private:
+        /// Adds a value to a counter with ldrex/strex and returns the new value.
+        STATIC_INLINE uint32_t add(volatile uint32_t& counter, const uint32_t value)
+        {
+            uint32_t result;
+            do
+            {
+                result = __LDREXW(&counter) + value;
+            } while (__STREXW(result, &counter) != 0u);
+            return result;
+        }
+
+        /// Returns the number of slots from a padding index to the end of the storage.
+        STATIC_INLINE uint32_t getPaddingSize(const uint32_t index)
+        {
+            return (0u - index) & (capacity - 1u);
+        }
+
+        volatile uint32_t reserved; ///< Index of the next slot which is claimed.
+        volatile uint32_t writers; ///< Number of producers which claimed slots and did not commit yet.
+        volatile uint32_t padding; ///< Index of the first slot of the last padding. It lasts up to the end of the storage.
+    };
+
+#endif
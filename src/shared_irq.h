@@ -0,0 +1,120 @@
+/// @file
+///
+/// @brief This file contains the dispatcher of shared irqs.
+///
+/// Many irqs of the FM4 are shared by several sources, e.g. the multi-function timer groups,
+/// PPG00_02_04 or the selectable IRQ003SEL to IRQ010SEL. The interrupt request batch read registers
+/// (INTREQ IRQxxxMON) contain one bit per source of irq xxx. The dispatcher reads this word once
+/// and walks the set bits with clz. Only the sources which actually requested the irq cost time, the
+/// number of enabled sources does not matter:
+///
+/// @code
+/// SharedIrq<MFT0_FRT_ZERO_IRQn>::setHandler(0, &frt0Handler); // bit 0 of IRQ025MON
+/// SharedIrq<MFT0_FRT_ZERO_IRQn>::setHandler(1, &frt1Handler); // bit 1 of IRQ025MON
+/// SharedIrq<MFT0_FRT_ZERO_IRQn>::install();
+/// @endcode
+///
+/// The bits of each monitor register are listed in the peripheral manual of the FM4 family. Each
+/// handler must clear the request flag of its source in the peripheral. A source without a handler
+/// must not have its interrupt enabled, because its request is never cleared.
+///
+/// The external interrupts 16 to 31 are handled by the EXINT module. It demultiplexes them in the
+/// same way with the EIRR register.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup SharedIrq
+
+#ifndef __SHARED_IRQ_H__
+#define __SHARED_IRQ_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "error.h"
+#include "isr.h"
+#include "utils.h"
+
+/// @brief This module contains the dispatcher of shared irqs.
+///
+/// @defgroup SharedIrq Shared IRQ Dispatcher
+
+/// Number of sources of a shared irq. It equals the width of the IRQxxxMON registers.
+/// @ingroup SharedIrq
+#define SHARED_IRQ_SOURCES 32
+
+/// @brief This template class dispatches a shared irq to the handlers of its sources.
+///
+/// @tparam irq The shared irq (0 - 127).
+/// @ingroup SharedIrq
+template<IRQn_Type irq>
+    struct SharedIrq
+    {
+        static_assert(irq >= 0 && irq < 128, "Only irqs of the peripherals are shared");
+
+        /// @brief Registers the handler of a source.
+        ///
+        /// The irq should be disabled in the nvic while a handler is changed.
+        ///
+        /// @param source The bit of the source in the IRQxxxMON register (0 - 31).
+        /// @param handler The handler. NULL removes the handler of the source.
+        STATIC_INLINE void setHandler(const uint8_t source, IInterruptServiceRoutine* handler)
+        {
+            handlers[source] = handler;
+            if (handler != NULL)
+            {
+                sources |= 1u << source;
+            }
+            else
+            {
+                sources &= ~(1u << source);
+            }
+        }
+
+        /// @brief Installs the dispatcher in the vector table and enables the irq in the nvic.
+        ///
+        /// @returns The previously installed interrupt service routine.
+        STATIC_INLINE IsrHandler install()
+        {
+            const IsrHandler previous = ISR_install(irq, &dispatch);
+            NVIC_ClearPendingIRQ(irq);
+            NVIC_EnableIRQ(irq);
+            return previous;
+        }
+
+        /// @brief The interrupt service routine of the shared irq.
+        ///
+        /// The requests are served from the highest to the lowest bit. Requests which are raised
+        /// while the routine is executed raise the irq again.
+        static void dispatch()
+        {
+            uint32_t pending = (&FM4_INTREQ->IRQ000MON)[irq] & sources;
+
+            while (pending != 0u)
+            {
+                const uint8_t source = 31u - __CLZ(pending);
+                pending &= ~(1u << source);
+
+                if (handlers[source]->isr() != RC_OK)
+                {
+                    ERROR_handler();
+                }
+            }
+        }
+
+    private:
+        static IInterruptServiceRoutine* handlers[SHARED_IRQ_SOURCES]; ///< The handlers of the sources.
+        static uint32_t sources; ///< Bit x is set when a handler is registered for source x.
+
+        /// Private constructor. This class cannot be instantiated. It only consits out of static methods.
+        SharedIrq();
+    };
+
+/// @cond TEMPLATE_DOC
+template<IRQn_Type irq>
+    IInterruptServiceRoutine* SharedIrq<irq>::handlers[SHARED_IRQ_SOURCES];
+
+template<IRQn_Type irq>
+    uint32_t SharedIrq<irq>::sources;
+/// @endcond
+
+#endif
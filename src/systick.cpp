@@ -10,21 +10,318 @@
 
 #include "systick.h"
 #include "gpio.h"
+#include "priority.h"
+#include "probe.h"
 
-SysTickController::SysTickController()
+/// The critical section which protects the buckets against tick().
+typedef CriticalSection<PRIORITY_SYSTICK> SysTickLock;
+
+LatencyHistogram SysTickController::latency(SysTick_IRQn);
+volatile uint32_t SysTickController::ticks;
+IInterruptServiceRoutine* SysTickController::subscribers[SYSTICK_SUBSCRIBERS];
+uint16_t SysTickController::buckets[SYSTICK_BUCKETS];
+uint32_t SysTickController::nextTicks[SYSTICK_SUBSCRIBERS];
+uint16_t SysTickController::periods[SYSTICK_SUBSCRIBERS];
+uint16_t SysTickController::ticklessSubscribers;
+
+/// Returns the greatest common divisor of two periods.
+static uint32_t getGcd(uint32_t a, uint32_t b)
 {
-    debugPin = &debugPinDummy;
+    while (b != 0u)
+    {
+        const uint32_t rest = a % b;
+        a = b;
+        b = rest;
+    }
+    return a;
 }
 
-ReturnCode SysTickController::isr()
+/// @brief Returns the number of subscribers which are ever due in the same tick as a new subscriber.
+///
+/// Two subscribers meet when the distance of their ticks is a multiple of the greatest common divisor
+/// of their periods. The new subscriber meets subscriber i when candidate mod gcds[i] = residues[i].
+///
+/// @param gcds The greatest common divisor of the new period and the period of each subscriber.
+/// @param residues The distance of the next tick of each subscriber to the first candidate modulo its gcd.
+/// @param count The number of subscribers.
+/// @param candidate The distance of the first tick of the new subscriber to the first candidate.
+static uint32_t getLoad(const uint16_t* gcds, const uint16_t* residues, const uint32_t count, const uint32_t candidate)
+{
+    uint32_t load = 0u;
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        if (candidate % gcds[i] == residues[i])
+        {
+            load++;
+        }
+    }
+    return load;
+}
+
+/// @brief Returns the distance of the first tick with the lowest load to the tick after a base tick.
+///
+/// It runs without the lock. The next tick of a subscriber moves by multiples of its period, its
+/// residue modulo a divisor of the period does not change. Subscribers whose period is coprime
+/// to the new one meet each candidate once and are skipped. The load repeats after the least common
+/// multiple of the other divisors, at most SYSTICK_BUCKETS candidates are checked.
+///
+/// @param subscribers The subscribers.
+/// @param nextTicks The next due tick of each subscriber.
+/// @param periods The period of each subscriber.
+/// @param base The base tick. It must not be later than the tick counter.
+/// @param period The period of the new subscriber.
+static uint32_t findPhase(IInterruptServiceRoutine* const* subscribers, const volatile uint32_t* nextTicks,
+        const uint16_t* periods, const uint32_t base, const uint16_t period)
+{
+    uint16_t gcds[SYSTICK_SUBSCRIBERS];
+    uint16_t residues[SYSTICK_SUBSCRIBERS];
+    uint32_t count = 0u;
+    uint32_t repeat = 1u; // the least common multiple of the gcds, it divides the period
+    for (uint32_t i = 0u; i < SYSTICK_SUBSCRIBERS; i++)
+    {
+        if (subscribers[i] == NULL)
+        {
+            continue;
+        }
+        const uint32_t gcd = getGcd(period, periods[i]);
+        if (gcd != 1u)
+        {
+            // The next tick lies after the base, the distance does not wrap.
+            gcds[count] = (uint16_t) gcd;
+            residues[count] = (uint16_t) ((nextTicks[i] - base - 1u) % gcd);
+            count++;
+            repeat = repeat / getGcd(repeat, gcd) * gcd;
+        }
+    }
+
+    const uint32_t candidates = (repeat < SYSTICK_BUCKETS) ? repeat : SYSTICK_BUCKETS;
+    uint32_t best = 0u;
+    uint32_t lowestLoad = getLoad(gcds, residues, count, 0u);
+    for (uint32_t candidate = 1u; candidate < candidates && lowestLoad != 0u; candidate++)
+    {
+        const uint32_t load = getLoad(gcds, residues, count, candidate);
+        if (load < lowestLoad)
+        {
+            lowestLoad = load;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+boolean_t SysTickController::subscribe(IInterruptServiceRoutine* subscriber, const uint16_t period, uint16_t phase)
+{
+    if (subscriber == NULL || period == 0u || (phase >= period && phase != SYSTICK_ANY_PHASE))
+    {
+        return FALSE;
+    }
+
+    // The search runs before the lock is taken, the systick is not masked meanwhile.
+    const uint32_t base = ticks;
+    uint32_t first; // the first tick t after the base with (t - 1) mod period = phase
+    if (phase == SYSTICK_ANY_PHASE)
+    {
+        first = base + 1u + findPhase(subscribers, nextTicks, periods, base, period);
+    }
+    else
+    {
+        first = base + 1u + (phase + period - base % period) % period;
+    }
+
+    SysTickLock lock;
+    uint8_t index = 0u;
+    while (index < SYSTICK_SUBSCRIBERS && subscribers[index] != NULL)
+    {
+        index++;
+    }
+    if (index == SYSTICK_SUBSCRIBERS)
+    {
+        return FALSE;
+    }
+
+    // Ticks which have passed since the base keep the phase.
+    const uint32_t late = ticks - first;
+    if ((int32_t) late >= 0)
+    {
+        first += (late / period + 1u) * period;
+    }
+
+    subscribers[index] = subscriber;
+    periods[index] = period;
+    nextTicks[index] = first;
+    buckets[first & (SYSTICK_BUCKETS - 1u)] |= (uint16_t) (1u << index);
+    return TRUE;
+}
+
+boolean_t SysTickController::subscribe(ITicklessSubscriber* subscriber, const uint16_t period, uint16_t phase)
+{
+    if (!subscribe(static_cast<IInterruptServiceRoutine*>(subscriber), period, phase))
+    {
+        return FALSE;
+    }
+
+    for (uint8_t index = 0u; index < SYSTICK_SUBSCRIBERS; index++)
+    {
+        if (subscribers[index] == subscriber)
+        {
+            ticklessSubscribers |= (uint16_t) (1u << index);
+        }
+    }
+    return TRUE;
+}
+
+void SysTickController::unsubscribe(IInterruptServiceRoutine* subscriber)
+{
+    for (uint8_t index = 0u; index < SYSTICK_SUBSCRIBERS; index++)
+    {
+        if (subscribers[index] == subscriber)
+        {
+            SysTickLock lock;
+            buckets[nextTicks[index] & (SYSTICK_BUCKETS - 1u)] &= (uint16_t) ~(1u << index);
+            ticklessSubscribers &= (uint16_t) ~(1u << index);
+            subscribers[index] = NULL;
+        }
+    }
+}
+
+uint32_t SysTickController::getCycles()
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    const uint32_t period = SysTick->LOAD + 1u;
+    uint32_t count = ticks;
+    const uint32_t value = SysTick->VAL;
+    // The counter has wrapped but the irq was not taken yet. A high value shows that the
+    // wrap happened before VAL was read.
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u && value > period / 2u)
+    {
+        count++;
+    }
+
+    __set_PRIMASK(primask);
+    return count * period + (period - 1u - value);
+}
+
+uint32_t SysTickController::getIdleTicks()
+{
+    // The stretched period must fit into the 24 bit counter.
+    uint32_t idle = (SysTick_LOAD_RELOAD_Msk + 1u) / (SysTick->LOAD + 1u);
+
+    // Plain subscribers run in each of their due ticks.
+    const uint32_t now = ticks;
+    for (uint8_t index = 0u; index < SYSTICK_SUBSCRIBERS; index++)
+    {
+        if (subscribers[index] != NULL && (ticklessSubscribers & (1u << index)) == 0u && nextTicks[index] - now < idle)
+        {
+            idle = nextTicks[index] - now;
+        }
+    }
+
+    uint32_t tickless = ticklessSubscribers;
+    while (tickless != 0u)
+    {
+        const uint8_t subscriber = 31u - __CLZ(tickless);
+        tickless &= ~(1u << subscriber);
+
+        const uint32_t count = static_cast<ITicklessSubscriber*>(subscribers[subscriber])->getIdleTicks();
+        if (count < idle)
+        {
+            idle = count;
+        }
+    }
+    return (idle != 0u) ? idle : 1u;
+}
+
+void SysTickController::skipTicks(const uint32_t count)
 {
-    debugPin->toggleOut();
-    return RC_OK;
+    const uint32_t now = ticks + count;
+    ticks = now;
+
+    // The tickless subscribers continue in their period. The plain ones are not due in the suppressed ticks.
+    for (uint8_t index = 0u; index < SYSTICK_SUBSCRIBERS; index++)
+    {
+        const uint32_t late = now - nextTicks[index];
+        if (subscribers[index] != NULL && (int32_t) late >= 0)
+        {
+            move(index, nextTicks[index] + (late / periods[index] + 1u) * periods[index]);
+        }
+    }
+
+    uint32_t tickless = ticklessSubscribers;
+    while (tickless != 0u)
+    {
+        const uint8_t subscriber = 31u - __CLZ(tickless);
+        tickless &= ~(1u << subscriber);
+
+        static_cast<ITicklessSubscriber*>(subscribers[subscriber])->skipTicks(count);
+    }
 }
 
-void SysTickController::registerDebugPin(IGpioPin *debugPin)
+uint32_t SysTickController::idle()
+{
+    const uint32_t period = SysTick->LOAD + 1u;
+    const uint32_t count = getIdleTicks();
+    if (count < 2u)
+    {
+        __DSB();
+        __WFI();
+        return 0u;
+    }
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    const uint32_t remaining = SysTick->VAL; // cycles until the end of the running tick
+    if (remaining == 0u || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u)
+    {
+        // The running tick has ended already. Its irq wakes the core up at once.
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        __DSB();
+        __WFI();
+        return 0u;
+    }
+
+    // The counter expires at the end of the tick with work. It reloads the stretched value at
+    // the first clock after it was enabled.
+    const uint32_t sleepPeriod = remaining + (count - 1u) * period;
+    SysTick->LOAD = sleepPeriod - 1u;
+    SysTick->VAL = 0u;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __DSB();
+    __WFI();
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    const uint32_t value = SysTick->VAL;
+    uint32_t skipped;
+    uint32_t sinceTick; // cycles since the end of the last tick
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u)
+    {
+        // The sleep has ended with the tick with work. Its irq counts that tick.
+        skipped = count - 1u;
+        sinceTick = (value != 0u) ? sleepPeriod - value : 0u;
+    }
+    else
+    {
+        // Another irq has woken the core up.
+        const uint32_t elapsed = (period - remaining) + (sleepPeriod - value);
+        skipped = elapsed / period;
+        sinceTick = elapsed % period;
+    }
+
+    // The counter expires at the end of the running tick and continues with the normal period.
+    const uint32_t untilTick = period - sinceTick;
+    SysTick->LOAD = (untilTick > 1u) ? untilTick - 1u : 1u;
+    SysTick->VAL = 0u;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    skipTicks(skipped);
+    SysTick->LOAD = period - 1u; // the counter has loaded the shortened value meanwhile
+    return skipped;
+}
+
+ReturnCode SysTickController::isr()
 {
-    this->debugPin = debugPin;
+    return tick();
 }
 
 
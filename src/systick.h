@@ -6,6 +6,19 @@
 /// unit. This also includes an interrupt service routine which can be registered to be
 /// called when a system tick interrupt is raised.
 ///
+/// Periodic work is attached to the systick as subscribers. A subscriber runs every period ticks,
+/// shifted by a phase offset. Subscribers with the same period but different phases run in different
+/// ticks, which spreads the load. Each subscriber keeps the tick in which it is due next. The
+/// subscribers are sorted into SYSTICK_BUCKETS buckets by the low bits of that tick, a tick only
+/// checks the subscribers of its own bucket. A subscriber whose period is longer than the buckets is
+/// checked once per turn of the buckets until it is due.
+///
+/// Tickless idle: idle() stretches the systick period up to the next tick in which a subscriber has
+/// work, sleeps and counts the suppressed ticks into the tick counter on wake. Plain subscribers
+/// limit the sleep to their next due tick. Subscribers which implement ITicklessSubscriber report
+/// their next deadline themselves and are informed about the suppressed ticks. The period of the
+/// systick counter is limited to 2^24 cycles, e.g. about 100 ticks of 1 ms at 160 MHz.
+///
 /// @author Christian Groeling <ch.groeling@gmail.com>
 
 #ifndef __SYSTICK_H__
@@ -14,26 +27,183 @@
 #include "utils.h"
 #include "gpio.h"
 #include "isr.h"
+#include "probe.h"
+#include "latency.h"
 #include "return_code.h"
+#include "base_types.h"
 
-/// This class manages all systick related functionalities.
-struct SysTickController : public IInterruptServiceRoutine
+/// Maximum number of systick subscribers.
+#define SYSTICK_SUBSCRIBERS 16
+
+/// Number of buckets of the subscribers (a power of 2). A subscriber is in the bucket of the low
+/// bits of its next due tick.
+#define SYSTICK_BUCKETS 32
+
+/// Phase argument of SysTickController::subscribe(). The phase which meets the fewest subscribers is
+/// chosen among the first SYSTICK_BUCKETS ticks.
+#define SYSTICK_ANY_PHASE 0xFFFFu
+
+/// Result of ITicklessSubscriber::getIdleTicks() when the subscriber has no work scheduled.
+#define SYSTICK_IDLE_FOREVER 0xFFFFFFFFu
+
+/// @brief Interface of systick subscribers which can skip ticks while the core sleeps.
+///
+/// Subscribers with a period of one tick which only do work at certain deadlines (timers,
+/// schedulers) should implement it. Otherwise they prevent the tickless idle.
+struct ITicklessSubscriber : public IInterruptServiceRoutine
 {
-    SysTickController();
+    /// @brief Returns the number of ticks until the subscriber has work to do.
+    ///
+    /// It is called with interrupts disabled.
+    ///
+    /// @returns n when isr() has nothing to do in the next n - 1 ticks, 1 when it has work in the
+    /// next tick or SYSTICK_IDLE_FOREVER.
+    virtual uint32_t getIdleTicks() = 0;
 
-    /// @brief This method is  used to register a gpio pin for debugging purposes.
+    /// @brief Informs the subscriber about suppressed ticks. isr() was not called for them.
     ///
-    /// The pin gets toggled each time the method isr is called.
+    /// It is called with interrupts disabled.
     ///
-    /// @param debugPin The debug pin which should be used.
-    void registerDebugPin(IGpioPin *debugPin);
+    /// @param count The number of suppressed ticks. It is lower than the last result of getIdleTicks().
+    virtual void skipTicks(const uint32_t count) = 0;
+};
 
+/// @brief The timing probe of the systick interrupt service routine.
+///
+/// DEBUG_PIN1 is high while the method SysTickController::tick() is executed. Use ProbeNone
+/// to disable only this probe.
+typedef ProbePin<DEBUG_PIN1> SysTickProbe;
+
+/// This class manages all systick related functionalities.
+struct SysTickController : public IInterruptServiceRoutine
+{
     /// Implements IInterruptServiceRoutine::isr()
     ReturnCode isr();
 
+    /// @brief Handles a systick irq.
+    ///
+    /// The method is bound directly to the systick vector (see IsrBinding). isr() calls it when
+    /// the controller is registered with ISR_registerSysTick().
+    STATIC_INLINE ReturnCode tick()
+    {
+        ScopedLatency<LatencyTriggerSysTick> monitor(latency);
+        ScopedProbe<SysTickProbe> probe;
+        const uint32_t now = ticks + 1u;
+        ticks = now;
+
+        // The due subscribers are moved to the bucket of their next tick first. They stay in their
+        // period, even when an isr() fails.
+        uint32_t due = 0u;
+        uint32_t candidates = buckets[now & (SYSTICK_BUCKETS - 1u)];
+        while (candidates != 0u)
+        {
+            const uint8_t subscriber = 31u - __CLZ(candidates);
+            candidates &= ~(1u << subscriber);
+
+            if (nextTicks[subscriber] == now) // otherwise due in a later turn of the buckets
+            {
+                due |= 1u << subscriber;
+                move(subscriber, now + periods[subscriber]);
+            }
+        }
+
+        while (due != 0u)
+        {
+            const uint8_t subscriber = 31u - __CLZ(due);
+            due &= ~(1u << subscriber);
+
+            const ReturnCode rc = subscribers[subscriber]->isr();
+            if (rc != RC_OK)
+            {
+                return rc;
+            }
+        }
+        return RC_OK;
+    }
+
+    /// @brief Adds a subscriber.
+    ///
+    /// The method isr() of the subscriber is called in the ticks t with (t - 1) mod period = phase,
+    /// where t is the tick counter in that tick. The tick counter is 1 in the first tick, so with
+    /// phase 0 the subscriber runs in the ticks 1, period + 1, 2 * period + 1 ... It must only be
+    /// called from thread mode.
+    ///
+    /// @param subscriber The subscriber.
+    /// @param period The period in ticks (1 - 65535).
+    /// @param phase The phase offset in ticks (0 - period - 1) or SYSTICK_ANY_PHASE.
+    /// @returns TRUE when the subscriber was added, FALSE when the table is full or the arguments are invalid.
+    static boolean_t subscribe(IInterruptServiceRoutine* subscriber, const uint16_t period, uint16_t phase);
+
+    /// @brief Adds a subscriber which supports the tickless idle. See subscribe().
+    ///
+    /// @param subscriber The subscriber.
+    /// @param period The period in ticks (1 - 65535).
+    /// @param phase The phase offset in ticks (0 - period - 1) or SYSTICK_ANY_PHASE.
+    /// @returns TRUE when the subscriber was added, FALSE when the table is full or the arguments are invalid.
+    static boolean_t subscribe(ITicklessSubscriber* subscriber, const uint16_t period, uint16_t phase);
+
+    /// @brief Removes a subscriber. It must only be called from thread mode.
+    ///
+    /// @param subscriber The subscriber.
+    static void unsubscribe(IInterruptServiceRoutine* subscriber);
+
+    /// @brief Returns the time since startup in core cycles.
+    ///
+    /// The time is composed of the tick counter and the systick counter. It keeps running while the
+    /// core sleeps, unlike the dwt cycle counter. It also includes a tick whose irq is still pending,
+    /// e.g. while interrupts are disabled.
+    ///
+    /// @returns The time. It wraps around after 2^32 cycles.
+    static uint32_t getCycles();
+
+    /// @brief Returns the number of ticks until a subscriber has work to do.
+    ///
+    /// It must be called with interrupts disabled.
+    ///
+    /// @returns n when no subscriber has work in the next n - 1 ticks. The result is limited by the
+    /// longest period of the systick counter.
+    static uint32_t getIdleTicks();
+
+    /// @brief Puts the core to sleep with wfi and suppresses the systick irqs which are not needed.
+    ///
+    /// The systick counter is reprogrammed to expire in the first tick with work (see getIdleTicks()).
+    /// On wake, the suppressed ticks are added to the tick counter and the subscribers. When fewer than
+    /// two ticks are idle, the systick keeps running and only wfi is executed.
+    ///
+    /// It must be called from thread mode with interrupts disabled. The irq which wakes the core up
+    /// is taken after the interrupts are enabled again, when the tick counter is correct already.
+    ///
+    /// @attention The counter is stopped for a few cycles at sleep and at wake. The tick counter
+    /// drifts by this time. SLEEPONEXIT must not be set, the counter would not be restored.
+    ///
+    /// @returns The number of suppressed ticks.
+    static uint32_t idle();
+
+    static LatencyHistogram latency; ///< Latency and execution time of tick().
+    static volatile uint32_t ticks; ///< Number of systick irqs since startup.
+
 private:
-    IGpioPin* debugPin; ///< A pointer to the debug pin
-    GpioDummyPin debugPinDummy; ///< A dummy gpio pin object  which is used when no debug pin was registered.
+    static IInterruptServiceRoutine* subscribers[SYSTICK_SUBSCRIBERS]; ///< The subscribers. NULL marks a free entry.
+    static uint16_t buckets[SYSTICK_BUCKETS]; ///< Bit x of bucket b is set when subscriber x is due next in a tick t with t mod SYSTICK_BUCKETS = b.
+    static uint32_t nextTicks[SYSTICK_SUBSCRIBERS]; ///< The tick in which each subscriber is due next.
+    static uint16_t periods[SYSTICK_SUBSCRIBERS]; ///< The period of each subscriber.
+    static uint16_t ticklessSubscribers; ///< Bit x is set when subscriber x implements ITicklessSubscriber.
+
+    /// @brief Moves a subscriber to the bucket of its next due tick.
+    ///
+    /// @param subscriber The index of the subscriber.
+    /// @param tick The next due tick.
+    STATIC_INLINE void move(const uint8_t subscriber, const uint32_t tick)
+    {
+        buckets[nextTicks[subscriber] & (SYSTICK_BUCKETS - 1u)] &= (uint16_t) ~(1u << subscriber);
+        nextTicks[subscriber] = tick;
+        buckets[tick & (SYSTICK_BUCKETS - 1u)] |= (uint16_t) (1u << subscriber);
+    }
+
+    /// @brief Counts suppressed ticks.
+    ///
+    /// @param count The number of ticks.
+    static void skipTicks(const uint32_t count);
 };
 
 
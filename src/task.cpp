@@ -0,0 +1,139 @@
+/// @file
+///
+/// @brief This file contains the implementation of the cooperative scheduler.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Task
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "error.h"
+#include "event_loop.h"
+#include "systick.h"
+#include "task.h"
+
+static Task* tasks; ///< The started tasks.
+static volatile uint32_t nextDeadline; ///< The earliest deadline of the tasks which wait for a tick.
+static volatile boolean_t deadlineArmed; ///< TRUE when a task waits for a tick.
+static volatile boolean_t polling; ///< TRUE when a task polls a condition.
+
+/// This class posts TASK_EVENT when a deadline has passed or a task polls. It is subscribed to the systick.
+struct TaskTimer : public ITicklessSubscriber
+{
+    /// Implements IInterruptServiceRoutine::isr()
+    ReturnCode isr()
+    {
+        if (polling || (deadlineArmed && (int32_t) (SysTickController::ticks - nextDeadline) >= 0))
+        {
+            EVENT_post(TASK_EVENT);
+        }
+        return RC_OK;
+    }
+
+    /// Implements ITicklessSubscriber::getIdleTicks()
+    uint32_t getIdleTicks()
+    {
+        if (polling)
+        {
+            return 1u;
+        }
+        if (!deadlineArmed)
+        {
+            return SYSTICK_IDLE_FOREVER;
+        }
+        const int32_t remaining = (int32_t) (nextDeadline - SysTickController::ticks);
+        return (remaining > 1) ? (uint32_t) remaining : 1u;
+    }
+
+    /// Implements ITicklessSubscriber::skipTicks(). The deadlines refer to the tick counter, which is corrected by the systick.
+    void skipTicks(const uint32_t)
+    {
+    }
+};
+
+static TaskTimer timer; ///< The systick subscriber of the scheduler.
+
+/// Returns TRUE when the wait of a task has ended. A signal is consumed.
+static boolean_t isResumable(Task* task, const uint32_t now)
+{
+    switch (task->wait)
+    {
+    case TASK_WAIT_TICK:
+        return (int32_t) (now - task->wakeTick) >= 0;
+    case TASK_WAIT_SIGNAL:
+        return task->signal->take();
+    default:
+        return TRUE;
+    }
+}
+
+void TASK_init()
+{
+    EVENT_setHandler(TASK_EVENT, &TASK_schedule);
+    if (!SysTickController::subscribe(&timer, 1u, SYSTICK_ANY_PHASE))
+    {
+        ERROR_handler();
+    }
+}
+
+void TASK_start(Task& task)
+{
+    task.resumePoint = 0u;
+    task.wait = TASK_WAIT_NONE;
+    task.next = tasks;
+    tasks = &task;
+    EVENT_post(TASK_EVENT);
+}
+
+void TASK_schedule()
+{
+    const uint32_t now = SysTickController::ticks;
+    boolean_t again = FALSE;
+    boolean_t armed = FALSE;
+    boolean_t poll = FALSE;
+    uint32_t deadline = 0u;
+
+    Task** link = &tasks;
+    while (*link != NULL)
+    {
+        Task* task = *link;
+
+        if (isResumable(task, now) && task->run() == TASK_DONE)
+        {
+            *link = task->next;
+            continue;
+        }
+
+        switch (task->wait)
+        {
+        case TASK_WAIT_NONE:
+            again = TRUE;
+            break;
+        case TASK_WAIT_TICK:
+            if (!armed || (int32_t) (task->wakeTick - deadline) < 0)
+            {
+                deadline = task->wakeTick;
+                armed = TRUE;
+            }
+            break;
+        case TASK_WAIT_SIGNAL:
+            // The signal may have been raised while this pass runs. Its event is already consumed.
+            again = again || task->signal->raised;
+            break;
+        default:
+            poll = TRUE;
+            break;
+        }
+        link = &task->next;
+    }
+
+    nextDeadline = deadline;
+    deadlineArmed = armed;
+    polling = poll;
+
+    if (again || (armed && (int32_t) (SysTickController::ticks - deadline) >= 0))
+    {
+        EVENT_post(TASK_EVENT);
+    }
+}
@@ -0,0 +1,219 @@
+/// @file
+///
+/// @brief This file contains the cooperative scheduler of stackless tasks.
+///
+/// A task is a resumable function in the style of protothreads. It runs on the stack of the event
+/// loop and returns to the scheduler at each wait. The wait point is stored in the task, execution
+/// continues behind it when the task is resumed. A task costs the size of the Task object (20
+/// bytes) plus the members of the derived class, it has no stack of its own:
+///
+/// @code
+/// struct BlinkTask : public Task
+/// {
+///     TaskState run()
+///     {
+///         TASK_BEGIN();
+///         while (1)
+///         {
+///             LedRed::setOutLow();
+///             TASK_SLEEP(100);
+///             LedRed::setOutHigh();
+///             TASK_AWAIT_SIGNAL(buttonPressed); // raised by ISR_ExternalInterrupt()
+///         }
+///         TASK_END();
+///     }
+/// };
+///
+/// static BlinkTask blink;
+///
+/// int main()
+/// {
+///     TASK_init();
+///     TASK_start(blink);
+///     EVENT_run(FALSE);
+/// }
+/// @endcode
+///
+/// A task can wait for
+/// * a systick deadline - TASK_SLEEP(), TASK_AWAIT_TICK(),
+/// * a signal which is raised by an interrupt service routine or a driver - TASK_AWAIT_SIGNAL(),
+/// * any condition - TASK_AWAIT(). The condition is polled once per tick,
+/// * the next pass of the scheduler - TASK_YIELD().
+///
+/// @attention Local variables of run() are lost at each wait, because the stack is unwound. Values
+/// which are needed after a wait must be members of the task. The wait macros must not be used
+/// inside a switch statement of run().
+///
+/// The scheduler is the handler of TASK_EVENT in the event loop (see event_loop.h). The event is
+/// posted by raised signals and, once per tick, when a deadline has passed or a task polls. The
+/// core sleeps while all tasks wait.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Task
+
+#ifndef __TASK_H__
+#define __TASK_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "event_loop.h"
+#include "systick.h"
+
+/// @brief This module contains the cooperative scheduler of stackless tasks.
+///
+/// @defgroup Task Stackless Tasks
+
+/// The event of the scheduler. Events are dispatched from the highest number, so the tasks run
+/// after all other event handlers.
+/// @ingroup Task
+#define TASK_EVENT 0
+
+/// This enum lists the results of Task::run().
+/// @ingroup Task
+enum TaskState
+{
+    TASK_WAITING, ///< The task waits and is resumed later.
+    TASK_DONE ///< The task has ended. It is removed from the scheduler.
+};
+
+/// This enum lists the conditions a task can wait for.
+/// @ingroup Task
+enum TaskWait
+{
+    TASK_WAIT_NONE, ///< The task is resumed in the next pass of the scheduler.
+    TASK_WAIT_TICK, ///< The task is resumed when the tick counter reaches Task::wakeTick.
+    TASK_WAIT_SIGNAL, ///< The task is resumed when Task::signal is raised.
+    TASK_WAIT_POLL ///< The task is resumed once per tick to check a condition.
+};
+
+/// @brief This class is a binary signal which resumes a waiting task.
+///
+/// Signals which are raised before a task waits for them are kept. Several raises before the
+/// task is resumed count as one.
+/// @ingroup Task
+struct TaskSignal
+{
+    /// Constructor. The signal is not raised.
+    TaskSignal() :
+            raised(FALSE)
+    {
+    }
+
+    /// @brief Raises the signal. It can be called from any interrupt service routine and from thread mode.
+    INLINE void raise()
+    {
+        raised = TRUE;
+        EVENT_post(TASK_EVENT);
+    }
+
+    /// @brief Consumes the signal. It is called by the scheduler.
+    ///
+    /// @returns TRUE when the signal was raised.
+    INLINE boolean_t take()
+    {
+        if (!raised)
+        {
+            return FALSE;
+        }
+        raised = FALSE;
+        return TRUE;
+    }
+
+    volatile boolean_t raised; ///< TRUE when the signal was raised and not consumed yet.
+};
+
+/// @brief This class is the base class of all tasks.
+///
+/// The derived class implements run() with the TASK_ macros.
+/// @ingroup Task
+struct Task
+{
+    /// Constructor. The task is not started.
+    Task() :
+            next(NULL), signal(NULL), wakeTick(0u), resumePoint(0u), wait(TASK_WAIT_NONE)
+    {
+    }
+
+    /// @brief The body of the task. It is called by the scheduler until it returns TASK_DONE.
+    ///
+    /// @returns The state of the task.
+    virtual TaskState run() = 0;
+
+    Task* next; ///< The next task of the scheduler. Private to the scheduler.
+    TaskSignal* signal; ///< The signal the task waits for.
+    uint32_t wakeTick; ///< The tick at which the task is resumed.
+    uint16_t resumePoint; ///< The line of the wait at which the task continues. 0 starts the task from the beginning.
+    uint8_t wait; ///< The condition the task waits for (see TaskWait).
+
+private:
+    /// The task must not be copied. The copy would resume in the middle of run().
+    Task(const Task&);
+
+    /// The task must not be copied. The copy would resume in the middle of run().
+    Task& operator=(const Task&);
+};
+
+/// @brief Starts the body of Task::run(). It must be the first statement.
+/// @ingroup Task
+#define TASK_BEGIN() switch (resumePoint) { case 0:
+
+/// @brief Ends the body of Task::run(). It must be the last statement. The task is done when it gets here.
+/// @ingroup Task
+#define TASK_END() } resumePoint = 0u; return TASK_DONE
+
+/// @brief Returns to the scheduler and continues in its next pass.
+/// @ingroup Task
+#define TASK_YIELD() \
+    do { wait = TASK_WAIT_NONE; resumePoint = __LINE__; return TASK_WAITING; case __LINE__:; } while (0)
+
+/// @brief Waits until the tick counter (SysTickController::ticks) reaches a deadline.
+///
+/// Periodic tasks advance the deadline by the period, so they do not drift.
+///
+/// @param tick The deadline. It must not lie more than 2^31 ticks in the future.
+/// @ingroup Task
+#define TASK_AWAIT_TICK(tick) \
+    do { wakeTick = (tick); wait = TASK_WAIT_TICK; resumePoint = __LINE__; return TASK_WAITING; case __LINE__:; } while (0)
+
+/// @brief Waits for a number of ticks.
+///
+/// @param duration The number of ticks.
+/// @ingroup Task
+#define TASK_SLEEP(duration) TASK_AWAIT_TICK(SysTickController::ticks + (duration))
+
+/// @brief Waits until a signal is raised. The signal is consumed.
+///
+/// @param taskSignal The TaskSignal.
+/// @ingroup Task
+#define TASK_AWAIT_SIGNAL(taskSignal) \
+    do { signal = &(taskSignal); wait = TASK_WAIT_SIGNAL; resumePoint = __LINE__; return TASK_WAITING; case __LINE__:; } while (0)
+
+/// @brief Waits until a condition is true. The condition is checked at once and then once per tick.
+///
+/// @param condition The condition. It is evaluated in thread mode.
+/// @ingroup Task
+#define TASK_AWAIT(condition) \
+    do { resumePoint = __LINE__; case __LINE__: if (!(condition)) { wait = TASK_WAIT_POLL; return TASK_WAITING; } } while (0)
+
+/// @brief This function initializes the scheduler.
+///
+/// It sets the handler of TASK_EVENT and subscribes the scheduler to the systick.
+/// @ingroup Task
+void TASK_init();
+
+/// @brief This function starts a task. It runs in the next pass of the scheduler.
+///
+/// It must only be called from thread mode. A task which is done can be started again.
+///
+/// @param task The task. It must not be running.
+/// @ingroup Task
+void TASK_start(Task& task);
+
+/// @brief This function executes one pass of the scheduler.
+///
+/// Each task whose wait has ended is resumed once. It is the handler of TASK_EVENT.
+/// @ingroup Task
+void TASK_schedule();
+
+#endif
@@ -0,0 +1,300 @@
+/// @file
+///
+/// @brief This file contains the implementation of the hierarchical timing wheel.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup TimingWheel
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+#include "error.h"
+#include "event_loop.h"
+#include "isr.h"
+#include "priority.h"
+#include "systick.h"
+#include "timer_wheel.h"
+
+/// The critical section which protects the wheel data.
+typedef CriticalSection<PRIORITY_SYSTICK> WheelLock;
+
+/// The longest remaining time which is placed by the expiry. Later timers are parked at this distance.
+static const uint32_t MAX_DISTANCE = (1u << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) - 1u;
+
+static WheelTimer* slots[WHEEL_LEVELS][WHEEL_SLOTS]; ///< The timers of each slot.
+static uint32_t occupied[WHEEL_LEVELS]; ///< Bit s of level l is set when slot s of level l contains timers.
+static WheelTimer* expiring; ///< The timers which expire in the actual tick.
+static WheelTimer* queued; ///< The expired thread context timers whose callbacks are not executed yet.
+static WheelTimer** queuedTail = &queued; ///< The last link of the queued timers.
+static volatile uint32_t now; ///< The last processed tick.
+
+/// This class advances the wheel. It is subscribed to the systick.
+struct WheelTicker : public ITicklessSubscriber
+{
+    /// Implements IInterruptServiceRoutine::isr()
+    ReturnCode isr()
+    {
+        WHEEL_advance();
+        return RC_OK;
+    }
+
+    /// Implements ITicklessSubscriber::getIdleTicks()
+    uint32_t getIdleTicks()
+    {
+        return WHEEL_getIdleTicks();
+    }
+
+    /// Implements ITicklessSubscriber::skipTicks()
+    void skipTicks(const uint32_t count)
+    {
+        WHEEL_skip(count);
+    }
+};
+
+static WheelTicker ticker; ///< The systick subscriber of the wheel.
+
+/// Adds a timer in front of a list.
+static INLINE void push(WheelTimer*& head, WheelTimer* timer)
+{
+    timer->next = head;
+    timer->link = &head;
+    if (head != NULL)
+    {
+        head->link = &timer->next;
+    }
+    head = timer;
+}
+
+/// Adds a timer to a slot.
+static INLINE void pushSlot(const uint32_t level, const uint32_t slot, WheelTimer* timer)
+{
+    push(slots[level][slot], timer);
+    occupied[level] |= 1u << slot;
+}
+
+/// Removes a timer from the list which contains it.
+static INLINE void unlink(WheelTimer* timer)
+{
+    WheelTimer** link = timer->link;
+    *link = timer->next;
+    if (timer->next != NULL)
+    {
+        timer->next->link = link;
+    }
+    else if (queuedTail == &timer->next)
+    {
+        queuedTail = link; // the last queued timer
+    }
+    else
+    {
+        // The last timer of a list. A slot is empty when the timer was also the first one.
+        WheelTimer** first = &slots[0][0];
+        if (link >= first && link < first + WHEEL_LEVELS * WHEEL_SLOTS)
+        {
+            const uint32_t index = (uint32_t) (link - first);
+            occupied[index / WHEEL_SLOTS] &= ~(1u << (index % WHEEL_SLOTS));
+        }
+    }
+    timer->link = NULL;
+}
+
+/// Returns the number of slots from the slot after the actual one to the first occupied slot of a level.
+static INLINE uint32_t getFreeSlots(const uint32_t level)
+{
+    const uint32_t shift = ((now >> (level * WHEEL_SLOT_BITS)) + 1u) & (WHEEL_SLOTS - 1u);
+    const uint32_t rotated = (occupied[level] >> shift) | (occupied[level] << ((WHEEL_SLOTS - shift) & (WHEEL_SLOTS - 1u)));
+    return __CLZ(__RBIT(rotated));
+}
+
+/// @brief Puts a timer into the slot of its expiry.
+///
+/// The level is the lowest one whose slots cover the remaining time. A timer which is due expires
+/// in the next tick.
+static void insert(WheelTimer* timer)
+{
+    int32_t remaining = (int32_t) (timer->expiry - now);
+    uint32_t distance = (remaining > 0) ? (uint32_t) remaining : 1u;
+    if (distance > MAX_DISTANCE)
+    {
+        distance = MAX_DISTANCE; // the timer is cascaded again when it is reached
+    }
+
+    // The highest bit of the distance selects the level.
+    const uint32_t level = (31u - __CLZ(distance)) / WHEEL_SLOT_BITS;
+    const uint32_t slot = ((now + distance) >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1u);
+    pushSlot(level, slot, timer);
+}
+
+/// Moves the timers of the actual slot of a level to the lower levels.
+static void cascade(const uint32_t level)
+{
+    WheelTimer*& head = slots[level][(now >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1u)];
+    while (head != NULL)
+    {
+        WheelTimer* timer = head;
+        unlink(timer);
+        if (timer->expiry == now)
+        {
+            pushSlot(0u, now & (WHEEL_SLOTS - 1u), timer); // level 0 is processed after the cascades
+        }
+        else
+        {
+            insert(timer);
+        }
+    }
+}
+
+void WHEEL_init()
+{
+    EVENT_setHandler(WHEEL_EVENT, &WHEEL_dispatch);
+    if (!SysTickController::subscribe(&ticker, 1u, SYSTICK_ANY_PHASE))
+    {
+        ERROR_handler();
+    }
+}
+
+void WHEEL_start(WheelTimer& timer, const uint32_t delay, const uint32_t period)
+{
+    WheelLock lock;
+    if (timer.link != NULL)
+    {
+        unlink(&timer);
+    }
+    timer.expiry = now + delay;
+    timer.period = period;
+    insert(&timer);
+}
+
+void WHEEL_cancel(WheelTimer& timer)
+{
+    WheelLock lock;
+    if (timer.link != NULL)
+    {
+        unlink(&timer);
+    }
+}
+
+boolean_t WHEEL_isActive(const WheelTimer& timer)
+{
+    return timer.link != NULL;
+}
+
+uint32_t WHEEL_getTime()
+{
+    return now;
+}
+
+void WHEEL_advance()
+{
+    WheelLock lock;
+    now = now + 1u;
+
+    // A level cascades when all slots of the level below have passed.
+    for (uint32_t level = 1u; level < WHEEL_LEVELS; level++)
+    {
+        if ((now & ((1u << (level * WHEEL_SLOT_BITS)) - 1u)) != 0u)
+        {
+            break;
+        }
+        cascade(level);
+    }
+
+    // The timers are moved to a list of their own. Callbacks may cancel or restart any of them.
+    WheelTimer*& head = slots[0][now & (WHEEL_SLOTS - 1u)];
+    expiring = head;
+    head = NULL;
+    occupied[0] &= ~(1u << (now & (WHEEL_SLOTS - 1u)));
+    if (expiring != NULL)
+    {
+        expiring->link = &expiring;
+    }
+
+    boolean_t post = FALSE;
+    while (expiring != NULL)
+    {
+        WheelTimer* timer = expiring;
+        unlink(timer);
+
+        if (timer->context == WHEEL_CONTEXT_ISR)
+        {
+            if (timer->period != 0u)
+            {
+                timer->expiry += timer->period;
+                insert(timer);
+            }
+            timer->callback(timer->argument);
+        }
+        else
+        {
+            // Append, so the callbacks are executed in the order of expiry.
+            timer->next = NULL;
+            timer->link = queuedTail;
+            *queuedTail = timer;
+            queuedTail = &timer->next;
+            post = TRUE;
+        }
+    }
+
+    if (post)
+    {
+        EVENT_post(WHEEL_EVENT);
+    }
+}
+
+uint32_t WHEEL_getIdleTicks()
+{
+    WheelLock lock;
+    uint32_t idle = SYSTICK_IDLE_FOREVER;
+    for (uint32_t level = 0u; level < WHEEL_LEVELS; level++)
+    {
+        if (occupied[level] == 0u)
+        {
+            continue;
+        }
+
+        // The first occupied slot of level 0 expires, the one of a higher level is cascaded.
+        const uint32_t shift = level * WHEEL_SLOT_BITS;
+        const uint32_t reached = ((now >> shift) + getFreeSlots(level) + 1u) << shift;
+        if (reached - now < idle)
+        {
+            idle = reached - now;
+        }
+    }
+    return idle;
+}
+
+void WHEEL_skip(const uint32_t count)
+{
+    WheelLock lock;
+    now = now + count;
+}
+
+void WHEEL_dispatch()
+{
+    while (1)
+    {
+        WheelCallback callback;
+        uint32_t argument;
+        {
+            WheelLock lock;
+            WheelTimer* timer = queued;
+            if (timer == NULL)
+            {
+                return;
+            }
+            unlink(timer);
+            callback = timer->callback;
+            argument = timer->argument;
+
+            // A periodic timer is restarted when its callback is executed. It stays in its period,
+            // even when the callback was delayed.
+            if (timer->period != 0u)
+            {
+                timer->expiry += timer->period;
+                insert(timer);
+            }
+        }
+
+        callback(argument);
+    }
+}
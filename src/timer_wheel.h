@@ -0,0 +1,175 @@
+/// @file
+///
+/// @brief This file contains the hierarchical timing wheel.
+///
+/// The wheel manages any number of software timers on the systick. Starting, canceling and
+/// expiring a timer costs constant time, independent of the number of active timers:
+///
+/// @code
+/// static void onTimeout(const uint32_t connection)
+/// {
+///     ... // thread mode
+/// }
+///
+/// static WheelTimer timeout(&onTimeout, 3, WHEEL_CONTEXT_THREAD);
+///
+/// WHEEL_start(timeout, 250); // onTimeout(3) is called in 250 ticks
+/// ...
+/// WHEEL_cancel(timeout); // the answer has arrived
+/// @endcode
+///
+/// The wheel has WHEEL_LEVELS levels of WHEEL_SLOTS slots. A slot of level l spans
+/// WHEEL_SLOTS^l ticks. A timer is put into the level whose span covers its remaining time and
+/// into the slot of its expiry. When the slots of a level have passed once, the next slot of the
+/// level above is cascaded: its timers are distributed over the lower levels. A timer moves down
+/// at most WHEEL_LEVELS - 1 times. Level 0 has a slot per tick, its timers expire when it is reached.
+///
+/// The timers are intrusive. They are linked into the slots by their own members, the wheel
+/// needs no dynamic memory.
+///
+/// Each timer is dispatched in one of two contexts:
+/// * WHEEL_CONTEXT_ISR - the callback is executed by the systick interrupt service routine. It
+///   must be short.
+/// * WHEEL_CONTEXT_THREAD - the timer is queued and the callback is executed by the handler of
+///   WHEEL_EVENT in the event loop (see event_loop.h).
+///
+/// The wheel data is protected with a CriticalSection at PRIORITY_SYSTICK. Timers can be started
+/// and canceled from thread mode, from callbacks and from interrupt service routines which do not
+/// have a higher priority than the systick.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup TimingWheel
+
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <stdint.h>
+#include "mcu.h"
+#include "base_types.h"
+
+/// @brief This module contains the hierarchical timing wheel.
+///
+/// @defgroup TimingWheel Timing Wheel
+
+/// Number of bits of the slot index of a level.
+/// @ingroup TimingWheel
+#define WHEEL_SLOT_BITS 5
+
+/// Number of slots of each level.
+/// @ingroup TimingWheel
+#define WHEEL_SLOTS (1u << WHEEL_SLOT_BITS)
+
+/// Number of levels. The wheel covers WHEEL_SLOTS^WHEEL_LEVELS ticks, i.e. more than 12 days at
+/// 1 ms. Timers which expire later are parked at the end of the top level and cascaded again.
+/// @ingroup TimingWheel
+#define WHEEL_LEVELS 6
+
+/// The event of the thread context callbacks.
+/// @ingroup TimingWheel
+#define WHEEL_EVENT 1
+
+/// Type of the callback of a timer.
+/// @ingroup TimingWheel
+typedef void (*WheelCallback)(const uint32_t argument);
+
+/// This enum lists the contexts in which a callback is executed.
+/// @ingroup TimingWheel
+enum WheelContext
+{
+    WHEEL_CONTEXT_ISR, ///< The callback is executed by the systick interrupt service routine.
+    WHEEL_CONTEXT_THREAD ///< The callback is executed by the event loop.
+};
+
+/// @brief This struct is a software timer.
+///
+/// The members are private to the wheel, except for the callback and its argument, which may be
+/// changed while the timer is not active.
+/// @ingroup TimingWheel
+struct WheelTimer
+{
+    /// @brief Constructor. The timer is not active.
+    ///
+    /// @param callback The callback.
+    /// @param argument The argument which is passed to the callback.
+    /// @param context The context of the callback (see WheelContext).
+    WheelTimer(WheelCallback callback, const uint32_t argument, const uint8_t context) :
+            next(NULL), link(NULL), expiry(0u), period(0u), callback(callback), argument(argument), context(context)
+    {
+    }
+
+    WheelTimer* next; ///< The next timer of the slot.
+    WheelTimer** link; ///< The pointer which points to this timer. NULL when the timer is not active.
+    uint32_t expiry; ///< The tick at which the timer expires.
+    uint32_t period; ///< The period of a periodic timer. 0 for a single shot.
+    WheelCallback callback; ///< The callback.
+    uint32_t argument; ///< The argument which is passed to the callback.
+    uint8_t context; ///< The context of the callback (see WheelContext).
+
+private:
+    /// The timer must not be copied. The copy would be linked into the wheel with the links of the original.
+    WheelTimer(const WheelTimer&);
+
+    /// The timer must not be copied. The copy would be linked into the wheel with the links of the original.
+    WheelTimer& operator=(const WheelTimer&);
+};
+
+/// @brief This function initializes the wheel.
+///
+/// It sets the handler of WHEEL_EVENT and subscribes the wheel to the systick.
+/// @ingroup TimingWheel
+void WHEEL_init();
+
+/// @brief This function starts a timer. An active timer is restarted.
+///
+/// @param timer The timer.
+/// @param delay The number of ticks until the timer expires (1 - 2^31 - 1). 0 expires in the next tick.
+/// @param period The period in ticks after which the timer expires again. 0 for a single shot.
+/// @ingroup TimingWheel
+void WHEEL_start(WheelTimer& timer, const uint32_t delay, const uint32_t period = 0u);
+
+/// @brief This function stops a timer. A queued thread context callback is dropped as well.
+///
+/// The function has no effect when the timer is not active.
+///
+/// @param timer The timer.
+/// @ingroup TimingWheel
+void WHEEL_cancel(WheelTimer& timer);
+
+/// @brief This function returns TRUE when a timer is active or its thread context callback is queued.
+///
+/// @param timer The timer.
+/// @ingroup TimingWheel
+boolean_t WHEEL_isActive(const WheelTimer& timer);
+
+/// @brief This function returns the time of the wheel.
+///
+/// @returns The number of ticks which were processed by the wheel.
+/// @ingroup TimingWheel
+uint32_t WHEEL_getTime();
+
+/// @brief This function advances the wheel by one tick and expires the timers of that tick.
+///
+/// It is called by the systick. The callbacks of ISR context timers are executed.
+/// @ingroup TimingWheel
+void WHEEL_advance();
+
+/// @brief This function returns the number of ticks until the wheel has work to do.
+///
+/// The work is the expiry of a timer or the cascade of an occupied slot. The wheel uses it for the
+/// tickless idle (see SysTickController::idle()).
+///
+/// @returns n when nothing happens in the next n - 1 ticks or SYSTICK_IDLE_FOREVER when no timer is active.
+/// @ingroup TimingWheel
+uint32_t WHEEL_getIdleTicks();
+
+/// @brief This function advances the wheel by ticks in which nothing happens.
+///
+/// @param count The number of ticks. It must be lower than the last result of WHEEL_getIdleTicks().
+/// @ingroup TimingWheel
+void WHEEL_skip(const uint32_t count);
+
+/// @brief This function executes the queued thread context callbacks. It is the handler of WHEEL_EVENT.
+/// @ingroup TimingWheel
+void WHEEL_dispatch();
+
+#endif
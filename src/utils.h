@@ -13,8 +13,9 @@
 /// This macro sets the gcc attribute "alway_inline" and makes the function/method static inline.
 #define STATIC_INLINE __attribute__( ( always_inline ) ) static inline
 
-/// This macro moves a function/method into the .ramfuncs section
-#define RAMFUNC __attribute__ ((section (".ramfuncs")))
+/// This macro moves a function/method into the .ramfuncs section. The function/method is never inlined,
+/// otherwise its code would end up in the section of the caller.
+#define RAMFUNC __attribute__ ((section (".ramfuncs"), noinline))
 
 /// This macro sets the gcc attribute "optimize" to O0. It can be used to exclude functions/methods from compiler optimization.
 #define DO_NOT_OPTIMIZE __attribute__((optimize("O0")))
@@ -0,0 +1,78 @@
+/// @file
+///
+/// @brief This file contains the minimal framework of the host tests.
+///
+/// Each test program in this directory is compiled with the host simulation (see host.h) and
+/// linked with the library of the host build. 'make test' builds and runs all programs. A program
+/// consists of test functions which are called by TEST_RUN() from main():
+///
+/// @code
+/// static void testSetOut()
+/// {
+///     GpioHal::setOut<GPIO_P27>(TRUE);
+///     TEST_ASSERT(FM4_GPIO->PDOR2 == 0x80u);
+/// }
+///
+/// int main()
+/// {
+///     TEST_RUN(testSetOut);
+///     return TEST_result();
+/// }
+/// @endcode
+///
+/// The register file is cleared by HOST_init() before each test function. Static data of the
+/// modules is not reset, a test must not depend on the state which a previous test leaves.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include "mcu.h"
+
+/// @cond HOST_DOC
+
+static uint32_t testFailures; ///< The number of failed assertions.
+static const char* testName; ///< The name of the running test function.
+
+static inline void TEST_check(const bool condition, const char* expression, const char* file, const int line)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "%s:%d: %s: assertion failed: %s\n", file, line, testName, expression);
+        testFailures++;
+    }
+}
+
+static inline void TEST_call(void (*test)(), const char* name)
+{
+    const uint32_t failures = testFailures;
+    testName = name;
+    HOST_init();
+    test();
+    printf("%s %s\n", (testFailures == failures) ? "passed" : "FAILED", name);
+}
+
+/// @endcond
+
+/// @brief Checks a condition. A failure is reported and the test continues.
+/// @ingroup Host
+#define TEST_ASSERT(condition) TEST_check((condition), #condition, __FILE__, __LINE__)
+
+/// @brief Runs a test function on a cleared register file.
+/// @ingroup Host
+#define TEST_RUN(test) TEST_call(&test, #test)
+
+/// @brief Returns the exit code of the test program.
+///
+/// @returns 0 when all assertions have passed, otherwise 1.
+/// @ingroup Host
+static inline int TEST_result()
+{
+    return (testFailures == 0u) ? 0 : 1;
+}
+
+#endif
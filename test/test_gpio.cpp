@@ -0,0 +1,113 @@
+/// @file
+///
+/// @brief This file contains the host tests of GpioHal.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#include "gpio.h"
+#include "test.h"
+
+/// The pins of port 3 which are changed by the port tests.
+static const uint32_t PORT3_PINS = 0x0F00u;
+
+/// init() writes the register settings of the function into the bits of the pin only.
+static void testInit()
+{
+    FM4_GPIO->PDOR2 = 0x0001u;
+    GpioHal::init<GPIO_P27, GPIO_OUTPUT_HIGH>();
+    TEST_ASSERT(FM4_GPIO->PDOR2 == 0x0081u);
+    TEST_ASSERT(FM4_GPIO->DDR2 == 0x0080u);
+    TEST_ASSERT(FM4_GPIO->PFR2 == 0u);
+    TEST_ASSERT(FM4_GPIO->PZR2 == 0u);
+
+    GpioHal::init<GPIO_P27>(GPIO_INPUT_PULLUP);
+    TEST_ASSERT(FM4_GPIO->PDOR2 == 0x0001u);
+    TEST_ASSERT(FM4_GPIO->DDR2 == 0u);
+    TEST_ASSERT(FM4_GPIO->PCR2 == 0x0080u);
+
+    GpioHal::init<GPIO_P38, GPIO_OUTPUT_OPEN_DRAIN>();
+    TEST_ASSERT(FM4_GPIO->PZR3 == 0x0100u);
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0x0100u);
+
+    GpioHal::init<GPIO_PE0, GPIO_PERIPHERAL>();
+    TEST_ASSERT(FM4_GPIO->PFRE == 0x0001u);
+}
+
+/// init() switches an analog input to digital.
+static void testInitAnalog()
+{
+    FM4_GPIO_ADE = 0xFFFFFFFFu;
+    GpioHal::init<GPIO_P13, GPIO_INPUT>();
+    TEST_ASSERT(FM4_GPIO_ADE == 0xFFFFFFF7u);
+
+    GpioHal::init<GPIO_P1E, GPIO_OUTPUT_LOW>();
+    TEST_ASSERT(FM4_GPIO_ADE == 0xFFFFBFF7u);
+
+    GpioHal::init<GPIO_P1F, GPIO_OUTPUT_LOW>();
+    GpioHal::init<GPIO_P27, GPIO_INPUT>();
+    TEST_ASSERT(FM4_GPIO_ADE == 0xFFFFBFF7u);
+
+    TEST_ASSERT(GpioPinTraits<GPIO_P10>::adeMask == 0x0001u);
+    TEST_ASSERT(GpioPinTraits<GPIO_P38>::adeMask == 0u);
+    TEST_ASSERT(GpioPinTraits<GPIO_P30>::analogInput == GPIO_HAL_UNKNOWN_ANALOG);
+}
+
+/// The single pin accesses change and read only the bit of the pin.
+static void testPin()
+{
+    GpioHal::setOut<GPIO_P1F>(TRUE);
+    TEST_ASSERT(FM4_GPIO->PDOR1 == 0x8000u);
+    GpioHal::toggleOut<GPIO_P1F>();
+    TEST_ASSERT(FM4_GPIO->PDOR1 == 0u);
+    GpioHal::toggleOut<GPIO_P1F>();
+    TEST_ASSERT(FM4_GPIO->PDOR1 == 0x8000u);
+    GpioHal::setOut<GPIO_P1F>(FALSE);
+    TEST_ASSERT(FM4_GPIO->PDOR1 == 0u);
+
+    FM4_GPIO->PDIRE = 0x0004u;
+    TEST_ASSERT(GpioHal::getIn<GPIO_PE2>() == TRUE);
+    TEST_ASSERT(GpioHal::getIn<GPIO_PE3>() == FALSE);
+}
+
+/// The port accesses change only the masked pins.
+static void testPort()
+{
+    FM4_GPIO->PDOR3 = 0x5005u;
+    GpioHal::writePortMasked<GPIO_PORT3, PORT3_PINS>(0xFAFFu);
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0x5A05u);
+    GpioHal::setPort<GPIO_PORT3, PORT3_PINS>();
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0x5F05u);
+    GpioHal::togglePort<GPIO_PORT3, 0x0300u>();
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0x5C05u);
+    GpioHal::clearPort<GPIO_PORT3, PORT3_PINS>();
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0x5005u);
+    GpioHal::writePortMasked<GPIO_PORT3, 0x0004u>(0u);
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0x5001u);
+    GpioHal::writePort<GPIO_PORT3>(0x1234u);
+    TEST_ASSERT(GpioHal::readPortOut<GPIO_PORT3>() == 0x1234u);
+
+    FM4_GPIO->PDIR3 = 0xA5A5u;
+    TEST_ASSERT(GpioHal::readPort<GPIO_PORT3>() == 0xA5A5u);
+}
+
+/// initPort() configures the selected pins and keeps the others.
+static void testInitPort()
+{
+    FM4_GPIO->DDR5 = 0x8000u;
+    GpioHal::initPort<GPIO_PORT5, 0x000Fu, 0x0003u, 0x0001u, 0x0004u, 0u, 0x0008u>();
+    TEST_ASSERT(FM4_GPIO->DDR5 == 0x8003u);
+    TEST_ASSERT(FM4_GPIO->PDOR5 == 0x0001u);
+    TEST_ASSERT(FM4_GPIO->PCR5 == 0x0004u);
+    TEST_ASSERT(FM4_GPIO->PFR5 == 0x0008u);
+}
+
+int main()
+{
+    TEST_RUN(testInit);
+    TEST_RUN(testInitAnalog);
+    TEST_RUN(testPin);
+    TEST_RUN(testPort);
+    TEST_RUN(testInitPort);
+    return TEST_result();
+}
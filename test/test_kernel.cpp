@@ -0,0 +1,195 @@
+/// @file
+///
+/// @brief This file contains the host tests of the kernel.
+///
+/// The threads do not run on the host. A test acts as the running thread: it calls the kernel
+/// functions in the name of KERNEL_current and takes the pended context switch with ISR_PendSV().
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#include "kernel.h"
+#include "test.h"
+
+/// The sleep of the threads which are not needed anymore. The kernel time does not advance on the host.
+static const uint32_t PARK_TICKS = 0x10000000u;
+
+/// Exception number of the base timer irq, which signals in testSignalFromIsr().
+static const uint32_t TIMER_EXCEPTION = 16u + BT1_IRQn;
+
+/// Size of the stack of each thread in bytes.
+static const uint32_t STACK_SIZE = 256u;
+
+/// The entry function of the threads. It is never executed on the host.
+static void entry(void*)
+{
+}
+
+/// Creates a thread and takes the context switch to the thread which runs next.
+static void createThread(KernelThread& thread, uint64_t* stack, const uint8_t priority)
+{
+    KERNEL_createThread(thread, &entry, NULL, stack, STACK_SIZE, priority);
+    ISR_PendSV();
+}
+
+/// Takes the pended context switch and checks the thread which runs next.
+static void switchTo(const KernelThread& thread)
+{
+    TEST_ASSERT(KERNEL_next == &thread);
+    ISR_PendSV();
+}
+
+/// Suspends the running thread for the rest of the program and switches to the next one.
+static void park()
+{
+    KERNEL_sleep(PARK_TICKS);
+    ISR_PendSV();
+}
+
+/// The priority is passed on along a chain of two mutexes and dropped again on unlock.
+static void testInheritanceChain()
+{
+    static KernelThread low;
+    static KernelThread middle;
+    static KernelThread high;
+    static uint64_t stacks[3][STACK_SIZE / sizeof(uint64_t)];
+    static KernelMutex first;
+    static KernelMutex second;
+
+    createThread(low, stacks[0], 2u);
+    TEST_ASSERT(KERNEL_current == &low);
+    KERNEL_lock(first);
+
+    createThread(middle, stacks[1], 4u);
+    TEST_ASSERT(KERNEL_current == &middle);
+    KERNEL_lock(second);
+    KERNEL_lock(first); // blocks, low inherits 4
+    TEST_ASSERT(low.priority == 4u);
+    switchTo(low);
+
+    createThread(high, stacks[2], 6u);
+    TEST_ASSERT(KERNEL_current == &high);
+    KERNEL_lock(second); // blocks, middle and low inherit 6
+    TEST_ASSERT(middle.priority == 6u);
+    TEST_ASSERT(low.priority == 6u);
+    switchTo(low);
+
+    // The first mutex is handed over to middle, which still inherits from high.
+    KERNEL_unlock(first);
+    TEST_ASSERT(first.owner == &middle);
+    TEST_ASSERT(low.priority == 2u);
+    TEST_ASSERT(middle.priority == 6u);
+    switchTo(middle);
+
+    KERNEL_unlock(first);
+    TEST_ASSERT(middle.priority == 6u);
+    KERNEL_unlock(second);
+    TEST_ASSERT(second.owner == &high);
+    TEST_ASSERT(middle.priority == 4u);
+    switchTo(high);
+
+    KERNEL_unlock(second);
+    TEST_ASSERT(second.owner == NULL);
+    TEST_ASSERT(high.mutexes == NULL && middle.mutexes == NULL && low.mutexes == NULL);
+
+    park();
+    TEST_ASSERT(KERNEL_current == &middle);
+    park();
+    TEST_ASSERT(KERNEL_current == &low);
+    park();
+}
+
+/// The mutex is handed over to the waiting thread with the highest priority, independent of the order of the waits.
+static void testHandOver()
+{
+    static KernelThread owner;
+    static KernelThread waiters[3];
+    static uint64_t stacks[4][STACK_SIZE / sizeof(uint64_t)];
+    static KernelMutex mutex;
+    static KernelSemaphore release(0u);
+    static const uint8_t priorities[3] = { 4u, 7u, 5u };
+
+    // The owner waits, so each waiter runs and locks, although the owner inherits its priority.
+    createThread(owner, stacks[0], 3u);
+    KERNEL_lock(mutex);
+    KERNEL_wait(release);
+    ISR_PendSV();
+    for (uint32_t i = 0u; i < 3u; i++)
+    {
+        createThread(waiters[i], stacks[i + 1u], priorities[i]);
+        TEST_ASSERT(KERNEL_current == &waiters[i]);
+        KERNEL_lock(mutex);
+        ISR_PendSV();
+    }
+    TEST_ASSERT(owner.priority == 7u);
+    KERNEL_signal(release);
+    switchTo(owner);
+
+    KERNEL_unlock(mutex);
+    TEST_ASSERT(mutex.owner == &waiters[1]);
+    TEST_ASSERT(owner.priority == 3u);
+    switchTo(waiters[1]);
+
+    // The new owner inherits from the remaining waiters. The thread which unlocks keeps running.
+    KERNEL_unlock(mutex);
+    TEST_ASSERT(mutex.owner == &waiters[2]);
+    TEST_ASSERT(waiters[2].priority == 5u);
+    TEST_ASSERT(KERNEL_next == &waiters[1]);
+    park();
+    TEST_ASSERT(KERNEL_current == &waiters[2]);
+
+    KERNEL_unlock(mutex);
+    TEST_ASSERT(mutex.owner == &waiters[0]);
+    TEST_ASSERT(mutex.waiters.head == NULL);
+    park();
+    TEST_ASSERT(KERNEL_current == &waiters[0]);
+
+    KERNEL_unlock(mutex);
+    TEST_ASSERT(mutex.owner == NULL);
+    park();
+    TEST_ASSERT(KERNEL_current == &owner);
+    park();
+}
+
+/// A semaphore which is signaled by an interrupt service routine readies the waiting thread.
+static void testSignalFromIsr()
+{
+    static KernelThread waiter;
+    static uint64_t stack[STACK_SIZE / sizeof(uint64_t)];
+    static KernelSemaphore semaphore(0u);
+
+    createThread(waiter, stack, 5u);
+    KERNEL_wait(semaphore);
+    ISR_PendSV();
+    TEST_ASSERT(KERNEL_current != &waiter);
+
+    // The unit is passed to the waiter, it is not counted.
+    HOST_ipsr = TIMER_EXCEPTION;
+    KERNEL_signal(semaphore);
+    TEST_ASSERT(semaphore.count == 0u);
+    TEST_ASSERT(KERNEL_next == &waiter);
+    HOST_ipsr = 0u;
+    switchTo(waiter);
+
+    // Without a waiter the unit is counted.
+    HOST_ipsr = TIMER_EXCEPTION;
+    KERNEL_signal(semaphore);
+    HOST_ipsr = 0u;
+    TEST_ASSERT(semaphore.count == 1u);
+    TEST_ASSERT(KERNEL_next == &waiter);
+    KERNEL_wait(semaphore);
+    TEST_ASSERT(semaphore.count == 0u);
+    TEST_ASSERT(KERNEL_next == &waiter);
+    park();
+}
+
+int main()
+{
+    HOST_init();
+    KERNEL_init();
+
+    TEST_RUN(testInheritanceChain);
+    TEST_RUN(testHandOver);
+    TEST_RUN(testSignalFromIsr);
+    return TEST_result();
+}
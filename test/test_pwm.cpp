@@ -0,0 +1,100 @@
+/// @file
+///
+/// @brief This file contains the host tests of the software pwm.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#include "pwm.h"
+#include "test.h"
+
+extern "C" void ISR_BaseTimer1();
+
+/// Length of the slot unit in timer cycles.
+static const uint32_t SLOT_UNIT = 10u;
+
+/// Base timer STC: underflow interrupt request
+static const uint8_t BT_STC_UDIR = 1u << 0;
+
+/// Returns the expected output level of a channel in a slot.
+static uint32_t getLevel(const uint8_t duty, const boolean_t activeLow, const uint32_t slot)
+{
+    const uint32_t level = (duty >> slot) & 1u;
+    return activeLow ? level ^ 1u : level;
+}
+
+/// Each slot outputs its bit plane and programs the length of the next slot.
+static void testPlanes()
+{
+    const uint8_t red = 0x05u; // active low on P27
+    const uint8_t green = 0xA0u; // active high on P38
+    const uint8_t blue = 0xFFu; // active low on P3A, always on
+
+    PWM_setChannel(0u, GPIO_P27, TRUE);
+    PWM_setChannel(1u, GPIO_P38, FALSE);
+    PWM_setChannel(2u, GPIO_P3A, TRUE);
+    PWM_setDuty(0u, red);
+    PWM_setDuty(1u, green);
+    PWM_setDuty(2u, blue);
+
+    // The other pins of the ports keep their levels.
+    FM4_GPIO->PDOR2 = 0x0001u;
+    FM4_GPIO->PDOR3 = 0x8000u;
+
+    PWM_start(SLOT_UNIT);
+    for (uint32_t step = 0u; step <= PWM_RESOLUTION; step++)
+    {
+        const uint32_t slot = step % PWM_RESOLUTION;
+        if (step != 0u)
+        {
+            FM4_BT1_RT->STC |= BT_STC_UDIR;
+            ISR_BaseTimer1();
+            TEST_ASSERT((FM4_BT1_RT->STC & BT_STC_UDIR) == 0u);
+        }
+
+        const uint32_t port2 = 0x0001u | (getLevel(red, TRUE, slot) << 7);
+        const uint32_t port3 = 0x8000u | (getLevel(green, FALSE, slot) << 8) | (getLevel(blue, TRUE, slot) << 10);
+        TEST_ASSERT(FM4_GPIO->PDOR2 == port2);
+        TEST_ASSERT(FM4_GPIO->PDOR3 == port3);
+
+        // The slot of bit b lasts 2^b slot units.
+        TEST_ASSERT(FM4_BT1_RT->PCSR == (SLOT_UNIT << ((slot + 1u) % PWM_RESOLUTION)) - 1u);
+    }
+    PWM_stop();
+}
+
+/// A duty cycle change takes effect in the next slots. A reassigned channel releases its pin.
+static void testChange()
+{
+    PWM_setChannel(0u, GPIO_P27, FALSE);
+    PWM_setChannel(1u, GPIO_P38, FALSE);
+    PWM_setChannel(2u, GPIO_P3A, FALSE);
+    PWM_setDuty(0u, 0xFFu);
+    PWM_setDuty(1u, 0x00u);
+
+    PWM_start(SLOT_UNIT);
+    TEST_ASSERT(FM4_GPIO->PDOR2 == 0x0080u);
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0u);
+
+    PWM_setDuty(0u, 0x00u);
+    PWM_setDuty(1u, 0xFFu);
+    ISR_BaseTimer1();
+    TEST_ASSERT(FM4_GPIO->PDOR2 == 0u);
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0x0100u);
+
+    // Channel 1 moves from P38 to P39. P38 keeps its last level.
+    PWM_setChannel(1u, GPIO_P39, FALSE);
+    ISR_BaseTimer1();
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0x0100u);
+    PWM_setDuty(1u, 0xFFu);
+    ISR_BaseTimer1();
+    TEST_ASSERT(FM4_GPIO->PDOR3 == 0x0300u);
+    PWM_stop();
+}
+
+int main()
+{
+    TEST_RUN(testPlanes);
+    TEST_RUN(testChange);
+    return TEST_result();
+}
@@ -0,0 +1,352 @@
+/// @file
+///
+/// @brief This file contains the host stress tests of the ring buffers.
+///
+/// The producers and consumers run at simulated priority levels. At each exclusive access and each
+/// memory barrier (see HOST_preemptionHook) a random context of a higher level may preempt the
+/// running one and runs to completion. The values carry the producer and a sequence number, so the
+/// consumer detects lost, duplicated and reordered elements.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#include "ring_buffer.h"
+#include "test.h"
+
+/// Number of operations of the thread context in each stress test.
+static const uint32_t OPERATIONS = 200000u;
+
+/// Capacity of the stress tested buffers. It is small, so the buffers run full and the indices wrap often.
+#define STRESS_CAPACITY 16
+
+/// Maximum number of priority levels. Level 0 is the thread context.
+#define MAX_LEVELS 4
+
+/// Type of a context which runs at a priority level.
+typedef void (*Context)();
+
+static Context contexts[MAX_LEVELS]; ///< The context of each level. Level 0 is run by the test itself.
+static uint32_t levels; ///< The number of levels of the running test.
+static uint32_t level; ///< The level of the running context.
+static uint32_t preemptions; ///< The number of simulated preemptions.
+static uint32_t seed; ///< The state of the random generator.
+static uint32_t errors; ///< The number of elements which were not read in the expected order.
+
+/// Returns a pseudo random number (xorshift).
+static uint32_t getRandom()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/// Implements HOST_preemptionHook. Runs a context of a higher level with a probability of 1/4.
+static uint32_t preempt()
+{
+    if (level + 1u >= levels || (getRandom() & 3u) != 0u)
+    {
+        return 0u;
+    }
+
+    const uint32_t preempted = level;
+    level = level + 1u + getRandom() % (levels - 1u - level);
+    preemptions++;
+    contexts[level]();
+    level = preempted;
+    return 1u;
+}
+
+/// Starts a stress test with the given contexts of the levels 1 - count - 1.
+static void startStress(const uint32_t count, const Context* isrs)
+{
+    levels = count;
+    level = 0u;
+    preemptions = 0u;
+    seed = 0x12345678u;
+    errors = 0u;
+    for (uint32_t i = 1u; i < count; i++)
+    {
+        contexts[i] = isrs[i - 1u];
+    }
+    HOST_preemptionHook = &preempt;
+}
+
+/// Ends the preemptions of a stress test. The remaining elements are read without preemption.
+static void stopStress()
+{
+    HOST_preemptionHook = NULL;
+    TEST_ASSERT(preemptions > OPERATIONS / 8u);
+}
+
+// *********************************************************************
+// Single producer, single consumer
+// *********************************************************************
+
+static SpscRingBuffer<uint32_t, STRESS_CAPACITY> spsc; ///< The buffer of the SPSC tests.
+static uint32_t spscWritten; ///< The sequence number of the next element which is written.
+static uint32_t spscRead; ///< The sequence number of the next element which is read.
+
+/// Writes elements, one by one or as span.
+static void produceSpsc()
+{
+    if ((getRandom() & 1u) != 0u)
+    {
+        if (spsc.push(spscWritten))
+        {
+            spscWritten++;
+        }
+        return;
+    }
+
+    uint32_t* span;
+    const uint32_t free = spsc.getWriteSpan(span);
+    const uint32_t count = (free != 0u) ? 1u + getRandom() % free : 0u;
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        span[i] = spscWritten + i;
+    }
+    spsc.commitWrite(count);
+    spscWritten += count;
+}
+
+/// Reads elements, one by one or as span.
+static void consumeSpsc()
+{
+    if ((getRandom() & 1u) != 0u)
+    {
+        uint32_t value;
+        if (spsc.pop(value))
+        {
+            errors += (value != spscRead) ? 1u : 0u;
+            spscRead++;
+        }
+        return;
+    }
+
+    const uint32_t* span;
+    const uint32_t available = spsc.getReadSpan(span);
+    const uint32_t count = (available != 0u) ? 1u + getRandom() % available : 0u;
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        errors += (span[i] != spscRead + i) ? 1u : 0u;
+    }
+    spsc.commitRead(count);
+    spscRead += count;
+}
+
+/// Reads all elements in thread context.
+static void drainSpsc()
+{
+    uint32_t value;
+    while (spsc.pop(value))
+    {
+        errors += (value != spscRead) ? 1u : 0u;
+        spscRead++;
+    }
+    TEST_ASSERT(spscRead == spscWritten);
+    TEST_ASSERT(errors == 0u);
+}
+
+/// The producer is an interrupt service routine, the consumer is the thread.
+static void testSpscToThread()
+{
+    const Context isrs[] = { &produceSpsc };
+    startStress(2u, isrs);
+    for (uint32_t i = 0u; i < OPERATIONS; i++)
+    {
+        consumeSpsc();
+        preempt();
+    }
+    stopStress();
+    drainSpsc();
+}
+
+/// The producer is the thread, the consumer is an interrupt service routine.
+static void testSpscToIsr()
+{
+    const Context isrs[] = { &consumeSpsc };
+    startStress(2u, isrs);
+    for (uint32_t i = 0u; i < OPERATIONS; i++)
+    {
+        produceSpsc();
+        preempt();
+    }
+    stopStress();
+    drainSpsc();
+}
+
+// *********************************************************************
+// Multiple producers, single consumer
+// *********************************************************************
+
+/// Number of producers of the MPSC test, one per level.
+#define MPSC_PRODUCERS MAX_LEVELS
+
+static MpscRingBuffer<uint32_t, STRESS_CAPACITY> mpsc; ///< The buffer of the MPSC test.
+static uint32_t mpscWritten[MPSC_PRODUCERS]; ///< The sequence number of the next element of each producer.
+static uint32_t mpscRead[MPSC_PRODUCERS]; ///< The sequence number of the next element of each producer which is read.
+
+/// Writes elements of the producer of the running level. Claims of 3 and 5 slots do not divide the capacity.
+static void produceMpsc()
+{
+    const uint32_t producer = level;
+    const uint32_t count = 1u + getRandom() % 5u;
+    if (count == 1u)
+    {
+        if (mpsc.push((producer << 24) | mpscWritten[producer]))
+        {
+            mpscWritten[producer]++;
+        }
+        return;
+    }
+
+    uint32_t* slots = mpsc.reserve(count);
+    if (slots == NULL)
+    {
+        return;
+    }
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        slots[i] = (producer << 24) | (mpscWritten[producer] + i);
+    }
+    mpscWritten[producer] += count;
+    mpsc.commit();
+}
+
+/// Checks an element which was read.
+static void checkMpsc(const uint32_t value)
+{
+    const uint32_t producer = value >> 24;
+    if (producer >= MPSC_PRODUCERS || (value & 0xFFFFFFu) != mpscRead[producer])
+    {
+        errors++;
+        return;
+    }
+    mpscRead[producer]++;
+}
+
+/// Reads elements, one by one or as span.
+static void consumeMpsc()
+{
+    if ((getRandom() & 1u) != 0u)
+    {
+        uint32_t value;
+        if (mpsc.pop(value))
+        {
+            checkMpsc(value);
+        }
+        return;
+    }
+
+    const uint32_t* span;
+    const uint32_t available = mpsc.getReadSpan(span);
+    const uint32_t count = (available != 0u) ? 1u + getRandom() % available : 0u;
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        checkMpsc(span[i]);
+    }
+    mpsc.commitRead(count);
+}
+
+/// Three interrupt service routines and the thread produce, the thread consumes.
+static void testMpsc()
+{
+    const Context isrs[] = { &produceMpsc, &produceMpsc, &produceMpsc };
+    startStress(MAX_LEVELS, isrs);
+    for (uint32_t i = 0u; i < OPERATIONS; i++)
+    {
+        if ((getRandom() & 1u) != 0u)
+        {
+            produceMpsc();
+        }
+        else
+        {
+            consumeMpsc();
+        }
+        preempt();
+    }
+    stopStress();
+
+    uint32_t value;
+    while (mpsc.pop(value))
+    {
+        checkMpsc(value);
+    }
+    for (uint32_t producer = 0u; producer < MPSC_PRODUCERS; producer++)
+    {
+        TEST_ASSERT(mpscRead[producer] == mpscWritten[producer]);
+        TEST_ASSERT(mpscWritten[producer] > OPERATIONS / 16u);
+    }
+    TEST_ASSERT(errors == 0u);
+}
+
+/// Claims which do not divide the capacity skip the end of the storage and never stall.
+static void testMpscPadding()
+{
+    MpscRingBuffer<uint32_t, 8> buffer;
+
+    // The claims at 0 and 3 fit, the claim at 6 needs the padding 6 - 7 and 3 free slots behind it.
+    TEST_ASSERT(buffer.reserve(3u) != NULL);
+    buffer.commit();
+    TEST_ASSERT(buffer.reserve(3u) != NULL);
+    buffer.commit();
+    TEST_ASSERT(buffer.reserve(3u) == NULL);
+
+    uint32_t value;
+    TEST_ASSERT(buffer.pop(value));
+    TEST_ASSERT(buffer.reserve(3u) == NULL);
+    for (uint32_t i = 0u; i < 5u; i++)
+    {
+        TEST_ASSERT(buffer.pop(value));
+    }
+
+    uint32_t* slots = buffer.reserve(3u);
+    TEST_ASSERT(slots != NULL);
+    slots[0] = 10u;
+    slots[1] = 11u;
+    slots[2] = 12u;
+    buffer.commit();
+    TEST_ASSERT(buffer.getCount() == 3u);
+
+    // The consumer skips the padding.
+    const uint32_t* span;
+    TEST_ASSERT(buffer.getReadSpan(span) == 3u);
+    TEST_ASSERT(span[0] == 10u && span[2] == 12u);
+    buffer.commitRead(3u);
+    TEST_ASSERT(buffer.isEmpty());
+
+    // Claims of 3 slots succeed forever when the consumer keeps up.
+    for (uint32_t i = 0u; i < 100u; i++)
+    {
+        slots = buffer.reserve(3u);
+        TEST_ASSERT(slots != NULL);
+        if (slots == NULL)
+        {
+            break;
+        }
+        slots[0] = i;
+        slots[1] = i + 1u;
+        slots[2] = i + 2u;
+        buffer.commit();
+        for (uint32_t k = 0u; k < 3u; k++)
+        {
+            TEST_ASSERT(buffer.pop(value) && value == i + k);
+        }
+    }
+
+    // A claim of half of the capacity needs up to 7 free slots. A larger one is rejected.
+    TEST_ASSERT(buffer.reserve(5u) == NULL);
+    TEST_ASSERT(buffer.reserve(4u) != NULL);
+    buffer.commit();
+    TEST_ASSERT(buffer.getCount() == 4u);
+}
+
+int main()
+{
+    TEST_RUN(testSpscToThread);
+    TEST_RUN(testSpscToIsr);
+    TEST_RUN(testMpsc);
+    TEST_RUN(testMpscPadding);
+    return TEST_result();
+}
@@ -0,0 +1,261 @@
+/// @file
+///
+/// @brief This file contains the host tests of SysTickController.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#include "systick.h"
+#include "test.h"
+
+/// This class records the ticks in which it is called.
+struct Recorder : public IInterruptServiceRoutine
+{
+    /// Constructor
+    Recorder() :
+            calls(0u), lastTick(0u), offPhase(0u), period(1u), phase(0u)
+    {
+    }
+
+    /// Implements IInterruptServiceRoutine::isr()
+    ReturnCode isr()
+    {
+        calls++;
+        lastTick = SysTickController::ticks;
+        if (lastTick % period != phase)
+        {
+            offPhase++;
+        }
+        return RC_OK;
+    }
+
+    uint32_t calls; ///< The number of calls.
+    uint32_t lastTick; ///< The tick counter at the last call.
+    uint32_t offPhase; ///< The number of calls in a tick which does not match period and phase.
+    uint16_t period; ///< The expected period.
+    uint16_t phase; ///< The expected phase (tick counter at the first tick is 1).
+};
+
+/// This class samples the pin of the systick probe.
+struct ProbeSampler : public IInterruptServiceRoutine
+{
+    /// Implements IInterruptServiceRoutine::isr()
+    ReturnCode isr()
+    {
+        level = FM4_GPIO->PDOR1 & 0x8000u;
+        return RC_OK;
+    }
+
+    uint32_t level; ///< The PDOR bit of DEBUG_PIN1 at the last call.
+};
+
+/// Runs the systick isr.
+static void runTicks(const uint32_t count)
+{
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        TEST_ASSERT(SysTickController::tick() == RC_OK);
+    }
+}
+
+/// The subscribers are called in their phase of their period.
+static void testSubscribe()
+{
+    Recorder fast;
+    Recorder slow;
+    Recorder spread;
+
+    // The tick counter is 1 in the first slot of the schedule.
+    fast.period = 4u;
+    fast.phase = 2u;
+    slow.period = 10u;
+    slow.phase = 8u;
+    spread.period = 4u;
+    TEST_ASSERT(SysTickController::subscribe(&fast, 4u, 1u));
+    TEST_ASSERT(SysTickController::subscribe(&slow, 10u, 7u));
+    TEST_ASSERT(SysTickController::subscribe(&spread, 4u, SYSTICK_ANY_PHASE));
+
+    runTicks(200u);
+    TEST_ASSERT(fast.calls == 50u);
+    TEST_ASSERT(fast.offPhase == 0u);
+    TEST_ASSERT(slow.calls == 20u);
+    TEST_ASSERT(slow.offPhase == 0u);
+    TEST_ASSERT(spread.calls == 50u);
+
+    // The chosen phase avoids the slot of the first subscriber with the same period.
+    TEST_ASSERT(spread.lastTick % 4u != fast.lastTick % 4u);
+
+    SysTickController::unsubscribe(&fast);
+    SysTickController::unsubscribe(&slow);
+    SysTickController::unsubscribe(&spread);
+    runTicks(20u);
+    TEST_ASSERT(fast.calls == 50u);
+    TEST_ASSERT(slow.calls == 20u);
+    TEST_ASSERT(spread.calls == 50u);
+}
+
+/// Any period is possible, also periods which are longer than the buckets.
+static void testAnyPeriod()
+{
+    Recorder three;
+    Recorder seven;
+    Recorder long1;
+    Recorder long2;
+
+    three.period = 3u;
+    three.phase = 0u;
+    seven.period = 7u;
+    seven.phase = 5u;
+    long1.period = 45u;
+    long1.phase = 45u; // not checked
+    long2.period = 1000u;
+    long2.phase = 1000u; // not checked
+    TEST_ASSERT(SysTickController::subscribe(&three, 3u, 2u));
+    TEST_ASSERT(SysTickController::subscribe(&seven, 7u, 4u));
+    TEST_ASSERT(SysTickController::subscribe(&long1, 45u, SYSTICK_ANY_PHASE));
+    TEST_ASSERT(SysTickController::subscribe(&long2, 1000u, SYSTICK_ANY_PHASE));
+
+    runTicks(2100u);
+    TEST_ASSERT(three.calls == 700u);
+    TEST_ASSERT(three.offPhase == 0u);
+    TEST_ASSERT(seven.calls == 300u);
+    TEST_ASSERT(seven.offPhase == 0u);
+    TEST_ASSERT(long1.calls == 46u || long1.calls == 47u);
+    TEST_ASSERT(long2.calls == 2u || long2.calls == 3u);
+
+    // The next calls follow the period.
+    const uint32_t last1 = long1.lastTick;
+    const uint32_t last2 = long2.lastTick;
+    runTicks(1000u);
+    TEST_ASSERT((long1.lastTick - last1) % 45u == 0u);
+    TEST_ASSERT(long2.lastTick == last2 + 1000u);
+
+    SysTickController::unsubscribe(&three);
+    SysTickController::unsubscribe(&seven);
+    SysTickController::unsubscribe(&long1);
+    SysTickController::unsubscribe(&long2);
+}
+
+/// The phase search of a long period next to subscribers of period 1 masks the systick for less than a tick.
+static void testAnyPhaseSearch()
+{
+    Recorder everyTick[SYSTICK_SUBSCRIBERS - 1];
+    Recorder slow;
+    slow.period = 65535u;
+    slow.phase = 65535u; // not checked
+
+    for (uint32_t i = 0u; i < SYSTICK_SUBSCRIBERS - 1u; i++)
+    {
+        TEST_ASSERT(SysTickController::subscribe(&everyTick[i], 1u, 0u));
+    }
+
+    // A tick of 1 ms would be lost while the search takes longer.
+    const uint32_t start = HOST_getClock();
+    TEST_ASSERT(SysTickController::subscribe(&slow, 65535u, SYSTICK_ANY_PHASE));
+    TEST_ASSERT(HOST_getClock() - start < 1000000u);
+
+    // The new subscriber is due within its first period, the others run in each tick.
+    runTicks(65535u);
+    TEST_ASSERT(slow.calls == 1u);
+    for (uint32_t i = 0u; i < SYSTICK_SUBSCRIBERS - 1u; i++)
+    {
+        TEST_ASSERT(everyTick[i].calls == 65535u);
+    }
+    const uint32_t last = slow.lastTick;
+    runTicks(65535u);
+    TEST_ASSERT(slow.calls == 2u);
+    TEST_ASSERT(slow.lastTick == last + 65535u);
+
+    for (uint32_t i = 0u; i < SYSTICK_SUBSCRIBERS - 1u; i++)
+    {
+        SysTickController::unsubscribe(&everyTick[i]);
+    }
+    SysTickController::unsubscribe(&slow);
+}
+
+/// The idle ticks end at the next due tick of the plain subscribers.
+static void testIdleTicks()
+{
+    Recorder recorder;
+    recorder.period = 7u;
+    recorder.phase = 7u; // not checked
+    SysTick->LOAD = 999u;
+
+    TEST_ASSERT(SysTickController::getIdleTicks() == (SysTick_LOAD_RELOAD_Msk + 1u) / 1000u);
+    TEST_ASSERT(SysTickController::subscribe(&recorder, 7u, SYSTICK_ANY_PHASE));
+    for (uint32_t i = 0u; i < 14u; i++)
+    {
+        const uint32_t idle = SysTickController::getIdleTicks();
+        TEST_ASSERT(idle >= 1u && idle <= 7u);
+        const uint32_t calls = recorder.calls;
+        runTicks(idle - 1u);
+        TEST_ASSERT(recorder.calls == calls);
+        runTicks(1u);
+        TEST_ASSERT(recorder.calls == calls + 1u);
+    }
+    SysTickController::unsubscribe(&recorder);
+}
+
+/// Invalid arguments and a full table are rejected.
+static void testSubscribeInvalid()
+{
+    Recorder recorders[SYSTICK_SUBSCRIBERS + 1];
+
+    TEST_ASSERT(!SysTickController::subscribe((IInterruptServiceRoutine*) NULL, 1u, 0u));
+    TEST_ASSERT(!SysTickController::subscribe(&recorders[0], 0u, 0u));
+    TEST_ASSERT(!SysTickController::subscribe(&recorders[0], 4u, 4u));
+
+    for (uint32_t i = 0u; i < SYSTICK_SUBSCRIBERS; i++)
+    {
+        TEST_ASSERT(SysTickController::subscribe(&recorders[i], 1u, 0u));
+    }
+    TEST_ASSERT(!SysTickController::subscribe(&recorders[SYSTICK_SUBSCRIBERS], 1u, 0u));
+
+    for (uint32_t i = 0u; i < SYSTICK_SUBSCRIBERS; i++)
+    {
+        SysTickController::unsubscribe(&recorders[i]);
+    }
+}
+
+/// The systick probe drives its pin high only while the isr runs.
+static void testProbe()
+{
+    ProbeSampler sampler;
+    sampler.level = 0u;
+    TEST_ASSERT(SysTickController::subscribe(&sampler, 1u, 0u));
+
+    runTicks(1u);
+    TEST_ASSERT(sampler.level != 0u);
+    TEST_ASSERT(FM4_GPIO->PDOR1 == 0u);
+    SysTickController::unsubscribe(&sampler);
+}
+
+/// The time includes the systick counter and a pending tick.
+static void testGetCycles()
+{
+    SysTick->LOAD = 999u;
+    SysTick->VAL = 200u;
+    const uint32_t ticks = SysTickController::ticks;
+    TEST_ASSERT(SysTickController::getCycles() == ticks * 1000u + 799u);
+
+    // The counter has wrapped, but the irq is pending.
+    SysTick->VAL = 990u;
+    SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+    TEST_ASSERT(SysTickController::getCycles() == (ticks + 1u) * 1000u + 9u);
+
+    // The irq was pending before the counter value was read.
+    SysTick->VAL = 10u;
+    TEST_ASSERT(SysTickController::getCycles() == ticks * 1000u + 989u);
+}
+
+int main()
+{
+    TEST_RUN(testSubscribe);
+    TEST_RUN(testAnyPeriod);
+    TEST_RUN(testAnyPhaseSearch);
+    TEST_RUN(testIdleTicks);
+    TEST_RUN(testSubscribeInvalid);
+    TEST_RUN(testProbe);
+    TEST_RUN(testGetCycles);
+    return TEST_result();
+}
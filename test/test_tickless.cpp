@@ -0,0 +1,226 @@
+/// @file
+///
+/// @brief This file contains the host tests of the tickless idle.
+///
+/// SysTickController::idle() runs on a simulated systick. The test keeps the real time in cycles.
+/// HOST_sleepHook advances it while the core sleeps and sets the systick counter and the pending
+/// bit like the hardware at the wake. The core either sleeps until the stretched counter expires or
+/// is woken up earlier by another irq, which starts a timer. After each wake the tick counter must
+/// match the real time, the wheel must follow the tick counter and each subscriber and timer must
+/// run exactly in its tick.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#include "systick.h"
+#include "timer_wheel.h"
+#include "test.h"
+
+/// Number of core cycles of a tick.
+static const uint32_t PERIOD = 1000u;
+
+/// Number of sleeps of the test.
+static const uint32_t SLEEPS = 20000u;
+
+/// Number of timers.
+#define TIMERS 256
+
+/// Period of the plain subscriber. It limits the sleeps.
+static const uint16_t PLAIN_PERIOD = 97u;
+
+/// Phase of the plain subscriber.
+static const uint16_t PLAIN_PHASE = 13u;
+
+static uint64_t now; ///< The real time in cycles. The tick t ends at t * PERIOD.
+static uint32_t seed; ///< The state of the random generator.
+static uint32_t earlyWakes; ///< The number of sleeps which were ended by another irq.
+static uint32_t errors; ///< The number of callbacks in an unexpected tick.
+static uint32_t starts; ///< The number of started timers.
+static uint32_t expiries; ///< The number of expired timers.
+static boolean_t draining; ///< TRUE when the irqs do not start timers anymore.
+
+static void onExpiry(const uint32_t index);
+
+/// This struct is a timer with the tick of its expected expiry.
+struct TestTimer
+{
+    /// Constructor
+    TestTimer() :
+            timer(&onExpiry, 0u, WHEEL_CONTEXT_ISR), expected(0u)
+    {
+    }
+
+    WheelTimer timer; ///< The timer.
+    uint32_t expected; ///< The wheel time of the expiry.
+};
+
+static TestTimer timers[TIMERS]; ///< The timers.
+
+/// This class is a plain subscriber, which does not support the tickless idle.
+struct PlainSubscriber : public IInterruptServiceRoutine
+{
+    /// Implements IInterruptServiceRoutine::isr()
+    ReturnCode isr()
+    {
+        calls++;
+        if ((SysTickController::ticks - 1u) % PLAIN_PERIOD != PLAIN_PHASE)
+        {
+            errors++;
+        }
+        return RC_OK;
+    }
+
+    uint32_t calls; ///< The number of calls.
+};
+
+static PlainSubscriber plain; ///< The plain subscriber.
+
+/// Returns a pseudo random number (xorshift).
+static uint32_t getRandom()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/// The callback of the timers.
+static void onExpiry(const uint32_t index)
+{
+    if (WHEEL_getTime() != timers[index].expected)
+    {
+        errors++;
+    }
+    expiries++;
+}
+
+/// Starts a timer which is not active with a random delay.
+static void startTimer(const uint32_t index)
+{
+    TestTimer& timer = timers[index];
+    if (WHEEL_isActive(timer.timer))
+    {
+        return;
+    }
+    const uint32_t delay = 1u + getRandom() % 3000u;
+    timer.timer.argument = index;
+    timer.expected = WHEEL_getTime() + delay;
+    WHEEL_start(timer.timer, delay);
+    starts++;
+}
+
+/// @brief Implements HOST_sleepHook. Simulates the time until the irq which wakes the core up.
+///
+/// A sleep without the stretched counter ends with the running tick. A stretched sleep ends when the
+/// counter expires, a few cycles later, or earlier with another irq.
+static void sleep()
+{
+    const uint32_t value = SysTick->VAL;
+    if (value != 0u)
+    {
+        // The counter runs with the normal period. The next irq is the end of the running tick.
+        now += value;
+        SysTick->VAL = 0u;
+        SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+        return;
+    }
+
+    // The counter was started with 0 and loads the stretched period at the first cycle.
+    const uint32_t sleepPeriod = SysTick->LOAD + 1u;
+    if ((getRandom() & 1u) != 0u)
+    {
+        const uint32_t wake = 1u + getRandom() % (sleepPeriod - 1u);
+        now += wake;
+        SysTick->VAL = sleepPeriod - wake;
+        earlyWakes++;
+    }
+    else
+    {
+        const uint32_t late = getRandom() % 10u;
+        now += sleepPeriod + late;
+        SysTick->VAL = (late != 0u) ? sleepPeriod - late : 0u;
+        SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+    }
+}
+
+/// Sleeps tickless and takes the irqs which wake the core up.
+static void idle()
+{
+    SysTick->LOAD = PERIOD - 1u;
+    SysTick->VAL = PERIOD - (uint32_t) (now % PERIOD); // cycles until the end of the running tick
+    SysTick->CTRL = SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk;
+
+    __disable_irq();
+    SysTickController::idle();
+    __enable_irq();
+
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u)
+    {
+        SCB->ICSR = 0u;
+        TEST_ASSERT(SysTickController::tick() == RC_OK);
+    }
+    else if (!draining)
+    {
+        startTimer(getRandom() % TIMERS); // the irq which has woken the core up
+    }
+    WHEEL_dispatch();
+}
+
+/// The tick counter, the wheel and the subscribers stay in step with the real time over sleeps which end early.
+static void testEarlyWake()
+{
+    seed = 0x13579BDFu;
+    draining = FALSE;
+    HOST_sleepHook = &sleep;
+    SysTick->LOAD = PERIOD - 1u;
+    TEST_ASSERT(SysTickController::subscribe(&plain, PLAIN_PERIOD, PLAIN_PHASE));
+
+    const uint32_t firstTick = SysTickController::ticks;
+    const uint32_t offset = WHEEL_getTime() - firstTick;
+    now = (uint64_t) firstTick * PERIOD + PERIOD / 2u;
+    for (uint32_t i = 0u; i < TIMERS; i++)
+    {
+        startTimer(i);
+    }
+
+    for (uint32_t i = 0u; i < SLEEPS; i++)
+    {
+        idle();
+        TEST_ASSERT(SysTickController::ticks == (uint32_t) (now / PERIOD));
+        TEST_ASSERT(WHEEL_getTime() - SysTickController::ticks == offset);
+    }
+    TEST_ASSERT(errors == 0u);
+    TEST_ASSERT(earlyWakes > SLEEPS / 4u);
+
+    // The plain subscriber has run in each of its ticks.
+    const uint32_t lastTick = SysTickController::ticks;
+    uint32_t due = 0u;
+    for (uint32_t tick = firstTick + 1u; tick != lastTick + 1u; tick++)
+    {
+        due += ((tick - 1u) % PLAIN_PERIOD == PLAIN_PHASE) ? 1u : 0u;
+    }
+    TEST_ASSERT(plain.calls == due);
+
+    // The remaining timers expire while the core sleeps.
+    draining = TRUE;
+    while (expiries != starts && SysTickController::ticks - lastTick < 4000u)
+    {
+        idle();
+    }
+    TEST_ASSERT(expiries == starts);
+    TEST_ASSERT(errors == 0u);
+    for (uint32_t i = 0u; i < TIMERS; i++)
+    {
+        WHEEL_cancel(timers[i].timer);
+    }
+    SysTickController::unsubscribe(&plain);
+}
+
+int main()
+{
+    HOST_init();
+    WHEEL_init();
+
+    TEST_RUN(testEarlyWake);
+    return TEST_result();
+}
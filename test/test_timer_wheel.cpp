@@ -0,0 +1,237 @@
+/// @file
+///
+/// @brief This file contains the host tests of the hierarchical timing wheel.
+///
+/// Each timer records the tick at which it is expected to expire. The callback compares it with the
+/// time of the wheel, so a timer which expires early, late or twice is detected.
+///
+/// @author Christian Groeling <ch.groeling@gmail.com>
+/// @ingroup Host
+
+#include "systick.h"
+#include "timer_wheel.h"
+#include "test.h"
+
+/// Number of timers of the random tests.
+#define TIMERS 3000
+
+/// Number of ticks of the random tests. All single shot timers expire within this time.
+static const uint32_t RANDOM_TICKS = 120000u;
+
+static void onExpiry(const uint32_t index);
+
+/// This struct is a timer with the tick of its next expected expiry.
+struct TestTimer
+{
+    /// Constructor
+    TestTimer() :
+            timer(&onExpiry, 0u, WHEEL_CONTEXT_ISR), expected(0u), calls(0u)
+    {
+    }
+
+    WheelTimer timer; ///< The timer.
+    uint32_t expected; ///< The tick of the next expiry.
+    uint32_t calls; ///< The number of calls of the callback.
+};
+
+static TestTimer timers[TIMERS]; ///< The timers.
+static uint32_t errors; ///< The number of expiries at an unexpected tick.
+static uint32_t seed; ///< The state of the random generator.
+
+/// Returns a pseudo random number (xorshift).
+static uint32_t getRandom()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/// The callback of the timers. A periodic timer expects its next expiry one period later.
+static void onExpiry(const uint32_t index)
+{
+    TestTimer& timer = timers[index];
+    if (WHEEL_getTime() != timer.expected)
+    {
+        errors++;
+    }
+    timer.calls++;
+    timer.expected += timer.timer.period;
+}
+
+/// Starts a timer. Even timers are dispatched by the event loop, odd ones by the systick.
+static void startTimer(const uint32_t index, const uint32_t delay, const uint32_t period)
+{
+    TestTimer& timer = timers[index];
+    timer.timer.argument = index;
+    timer.timer.context = ((index & 1u) != 0u) ? WHEEL_CONTEXT_ISR : WHEEL_CONTEXT_THREAD;
+    timer.expected = WHEEL_getTime() + delay;
+    timer.calls = 0u;
+    WHEEL_start(timer.timer, delay, period);
+}
+
+/// Cancels all timers. The wheel is empty afterwards.
+static void cancelAll()
+{
+    for (uint32_t i = 0u; i < TIMERS; i++)
+    {
+        WHEEL_cancel(timers[i].timer);
+    }
+    TEST_ASSERT(WHEEL_getIdleTicks() == SYSTICK_IDLE_FOREVER);
+}
+
+/// @brief Advances the wheel to a tick.
+///
+/// Tickless, the ticks without work are skipped like in SysTickController::idle().
+///
+/// @param end The tick.
+/// @param tickless TRUE to skip the idle ticks.
+static void runUntil(const uint32_t end, const boolean_t tickless)
+{
+    while (WHEEL_getTime() != end)
+    {
+        if (tickless)
+        {
+            const uint32_t idle = WHEEL_getIdleTicks();
+            const uint32_t remaining = end - WHEEL_getTime();
+            const uint32_t count = (idle < remaining) ? idle : remaining;
+            if (count > 1u)
+            {
+                WHEEL_skip(count - 1u);
+            }
+        }
+        WHEEL_advance();
+        WHEEL_dispatch();
+    }
+}
+
+/// @brief Runs random single shot and periodic timers, of which some are restarted and canceled.
+///
+/// @param tickless TRUE to skip the idle ticks.
+static void runRandomTimers(const boolean_t tickless)
+{
+    errors = 0u;
+    seed = 0x2468ACE1u;
+    for (uint32_t i = 0u; i < TIMERS; i++)
+    {
+        // Some timers reach the levels above 1 and cascade.
+        const uint32_t delay = (i % 10u == 0u) ? 1u + getRandom() % 100000u : 1u + getRandom() % 3000u;
+        const uint32_t period = (i % 50u == 0u) ? 1u + getRandom() % 500u : 0u;
+        startTimer(i, delay, period);
+    }
+    for (uint32_t i = 0u; i < TIMERS; i += 11u)
+    {
+        startTimer(i, 1u + getRandom() % 5000u, timers[i].timer.period);
+    }
+    for (uint32_t i = 0u; i < TIMERS; i += 7u)
+    {
+        WHEEL_cancel(timers[i].timer);
+        TEST_ASSERT(!WHEEL_isActive(timers[i].timer));
+    }
+
+    const uint32_t end = WHEEL_getTime() + RANDOM_TICKS;
+    runUntil(end, tickless);
+    TEST_ASSERT(errors == 0u);
+
+    uint32_t wrong = 0u;
+    for (uint32_t i = 0u; i < TIMERS; i++)
+    {
+        const TestTimer& timer = timers[i];
+        const uint32_t period = timer.timer.period;
+        if (i % 7u == 0u)
+        {
+            wrong += (timer.calls != 0u) ? 1u : 0u;
+        }
+        else if (period == 0u)
+        {
+            wrong += (timer.calls != 1u || WHEEL_isActive(timer.timer)) ? 1u : 0u;
+        }
+        else
+        {
+            // The next expiry of a periodic timer lies within a period after the end.
+            const int32_t ahead = (int32_t) (timer.expected - end);
+            wrong += (timer.calls == 0u || ahead <= 0 || ahead > (int32_t) period) ? 1u : 0u;
+        }
+    }
+    TEST_ASSERT(wrong == 0u);
+    cancelAll();
+}
+
+/// Random timers expire exactly at their tick when the wheel is advanced tick by tick.
+static void testRandomTimers()
+{
+    runRandomTimers(FALSE);
+}
+
+/// Random timers expire exactly at their tick when the idle ticks are skipped.
+static void testRandomTimersTickless()
+{
+    runRandomTimers(TRUE);
+}
+
+/// Timers next to the span of each level expire exactly, also when their expiry is the cascade of a slot.
+static void testLevelBoundaries()
+{
+    errors = 0u;
+    uint32_t index = 0u;
+    uint32_t end = WHEEL_getTime();
+    for (uint32_t level = 1u; level < 5u; level++)
+    {
+        const uint32_t span = 1u << (level * WHEEL_SLOT_BITS);
+        const uint32_t toBoundary = span - (WHEEL_getTime() & (span - 1u));
+        const uint32_t delays[] = { span - 1u, span, span + 1u, toBoundary - 1u, toBoundary, toBoundary + 1u,
+                toBoundary + span };
+        for (uint32_t i = 0u; i < sizeof(delays) / sizeof(delays[0]); i++)
+        {
+            startTimer(index, delays[i], 0u);
+            if ((int32_t) (timers[index].expected - end) > 0)
+            {
+                end = timers[index].expected;
+            }
+            index++;
+        }
+    }
+
+    runUntil(end, TRUE);
+    TEST_ASSERT(errors == 0u);
+    for (uint32_t i = 0u; i < index; i++)
+    {
+        TEST_ASSERT(timers[i].calls == 1u);
+    }
+    cancelAll();
+}
+
+/// Timers beyond the range of the wheel are parked and cascaded again until they expire.
+static void testParkedTimers()
+{
+    // The wheel places remaining times up to WHEEL_SLOTS^WHEEL_LEVELS - 1 ticks.
+    const uint32_t range = 1u << (WHEEL_SLOT_BITS * WHEEL_LEVELS);
+    errors = 0u;
+    startTimer(0u, range - 1u, 0u);
+    startTimer(1u, range, 0u);
+    startTimer(2u, range + 12345u, 0u);
+    startTimer(3u, 0x7FFFFFFFu, 0u);
+    startTimer(4u, range + 7u, range + 3u); // periodic beyond the range
+
+    runUntil(timers[3].expected + 1u, TRUE);
+    TEST_ASSERT(errors == 0u);
+    for (uint32_t i = 0u; i < 4u; i++)
+    {
+        TEST_ASSERT(timers[i].calls == 1u);
+    }
+    TEST_ASSERT(timers[4].calls == 1u);
+    TEST_ASSERT(WHEEL_isActive(timers[4].timer));
+    cancelAll();
+}
+
+int main()
+{
+    HOST_init();
+    WHEEL_init();
+
+    TEST_RUN(testRandomTimers);
+    TEST_RUN(testRandomTimersTickless);
+    TEST_RUN(testLevelBoundaries);
+    TEST_RUN(testParkedTimers);
+    return TEST_result();
+}